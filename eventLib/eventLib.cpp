@@ -0,0 +1,192 @@
+
+#include "eventLib.h"
+#include "eventLibP.h"
+#include "taskLibP.h"
+#include "tickLib.h"
+
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+/*
+ * The register is TASK_TCB.events. Bit 31 (EV_WAITER) is set by a task
+ * before it sleeps on the register with FUTEX_WAIT, and cleared when it
+ * stops waiting. A sender ORs its bits in and only enters the kernel
+ * (FUTEX_WAKE) when the old value had EV_WAITER set.
+ */
+
+#define EV_WAITER 0x80000000u
+
+static int ev_futex_wait(uint32_t* word, uint32_t val, const struct timespec* ts, int absolute) {
+    if (absolute)
+        return (int)syscall(SYS_futex, word, FUTEX_WAIT_BITSET_PRIVATE, val, ts, NULL, FUTEX_BITSET_MATCH_ANY);
+    return (int)syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, val, ts, NULL, 0);
+}
+
+static void ev_futex_wake(uint32_t* word) {
+    syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+static int ev_satisfied(uint32_t got, uint32_t wanted, int options) {
+    if (options & EVENTS_WAIT_ANY) return got != 0;
+    return got == wanted;
+}
+
+static uint64_t ev_mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+int eventReceive(uint32_t events, int options, int timeoutTicks, uint32_t* pEventsReceived) {
+    TASK_TCB* self = taskTcbSelf();
+    if (!self) return ERROR;
+    uint32_t* reg = &self->events;
+    events &= ~EV_WAITER;
+
+    if (options & EVENTS_FETCH) {
+        uint32_t w = __atomic_load_n(reg, __ATOMIC_ACQUIRE) & ~EV_WAITER;
+        if (pEventsReceived) *pEventsReceived = w;
+        return OK;
+    }
+    if (events == 0) {
+        errno = EINVAL;
+        return ERROR;
+    }
+
+    int virt = 0;
+    uint64_t expiryTick = 0;
+    struct timespec deadline = {0, 0};
+    if (timeoutTicks > 0) {
+        virt = tickVirtualModeGet();
+        if (virt) {
+            expiryTick = tickGet() + (uint64_t)timeoutTicks;
+        } else {
+            int rate = sysClkRateGet();
+            uint64_t tps = rate > 0 ? (uint64_t)rate : 60;
+            uint64_t ns = ev_mono_ns() + ((uint64_t)timeoutTicks * 1000000000ULL + tps - 1) / tps;
+            deadline.tv_sec = (time_t)(ns / 1000000000ULL);
+            deadline.tv_nsec = (long)(ns % 1000000000ULL);
+        }
+    }
+
+    int result = OK, err = 0;
+    uint32_t w = __atomic_load_n(reg, __ATOMIC_ACQUIRE);
+    for (;;) {
+        uint32_t got = w & events;
+        if (ev_satisfied(got, events, options)) {
+            uint32_t ret = (options & EVENTS_RETURN_ALL) ? (w & ~EV_WAITER) : got;
+            uint32_t left = (options & EVENTS_KEEP_UNWANTED) && !(options & EVENTS_RETURN_ALL)
+                            ? (w & ~got & ~EV_WAITER) : 0;
+            if (!__atomic_compare_exchange_n(reg, &w, left, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+                continue;   // a sender got in between; w is reloaded
+            if (pEventsReceived) *pEventsReceived = ret;
+            break;
+        }
+
+        int expired = timeoutTicks == NO_WAIT;
+        if (!expired && timeoutTicks > 0) {
+            if (virt) expired = tickGet() >= expiryTick;
+            else expired = ev_mono_ns() >= (uint64_t)deadline.tv_sec * 1000000000ULL + (uint64_t)deadline.tv_nsec;
+        }
+        if (expired) {
+            // stop advertising the wait; keep what arrived in the register
+            while ((w & EV_WAITER) &&
+                   !__atomic_compare_exchange_n(reg, &w, w & ~EV_WAITER, 1, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+                ;
+            if (ev_satisfied(w & events, events, options)) continue;   // arrived just now
+            if (pEventsReceived) *pEventsReceived = w & events;
+            result = ERROR;
+            err = timeoutTicks == NO_WAIT ? EAGAIN : ETIMEDOUT;
+            break;
+        }
+
+        if (!(w & EV_WAITER)) {
+            if (!__atomic_compare_exchange_n(reg, &w, w | EV_WAITER, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+                continue;
+            w |= EV_WAITER;
+        }
+        __atomic_or_fetch(&self->state, TASK_STATE_PEND, __ATOMIC_RELAXED);
+        if (timeoutTicks < 0) {
+            ev_futex_wait(reg, w, NULL, 0);
+        } else if (virt) {
+            // virtual time: re-check the tick count every TICK_VIRTUAL_POLL_MS
+            struct timespec slice = {0, TICK_VIRTUAL_POLL_MS * 1000000L};
+            ev_futex_wait(reg, w, &slice, 0);
+        } else {
+            ev_futex_wait(reg, w, &deadline, 1);
+        }
+        __atomic_and_fetch(&self->state, ~TASK_STATE_PEND, __ATOMIC_RELAXED);
+        w = __atomic_load_n(reg, __ATOMIC_ACQUIRE);
+    }
+
+    if (result != OK) errno = err;
+    return result;
+}
+
+int eventSend(TASK_ID tid, uint32_t events) {
+    TASK_TCB* tcb = tid ? (TASK_TCB*)tid : taskTcbSelf();
+    if (!tcb || (events & EV_WAITER) ||
+        __atomic_load_n(&tcb->magic, __ATOMIC_ACQUIRE) != TASK_MAGIC) {
+        errno = EINVAL;
+        return ERROR;
+    }
+    uint32_t old = __atomic_fetch_or(&tcb->events, events, __ATOMIC_RELEASE);
+    if (old & EV_WAITER) ev_futex_wake(&tcb->events);
+    return OK;
+}
+
+int eventClear(void) {
+    TASK_TCB* self = taskTcbSelf();
+    if (!self) return ERROR;
+    __atomic_and_fetch(&self->events, EV_WAITER, __ATOMIC_RELEASE);
+    return OK;
+}
+
+int eventRsrcStart(EVENTS_RSRC* rsrc, uint32_t events, int options) {
+    TASK_ID self = taskIdSelf();
+    if (!rsrc || !self || events == 0 || (events & EV_WAITER)) {
+        errno = EINVAL;
+        return ERROR;
+    }
+    // a registration left behind by a deleted task does not block (TCBs are never freed)
+    TASK_TCB* cur = (TASK_TCB*)__atomic_load_n(&rsrc->task, __ATOMIC_ACQUIRE);
+    if (cur && cur != (TASK_TCB*)self &&
+        __atomic_load_n(&cur->magic, __ATOMIC_ACQUIRE) == TASK_MAGIC &&
+        !(__atomic_load_n(&rsrc->options, __ATOMIC_RELAXED) & EVENTS_ALLOW_OVERWRITE)) {
+        errno = EBUSY;
+        return ERROR;
+    }
+    // unpublish first so no send pairs the old task with the new events
+    __atomic_store_n(&rsrc->task, (TASK_ID)NULL, __ATOMIC_RELEASE);
+    __atomic_store_n(&rsrc->events, events, __ATOMIC_RELAXED);
+    __atomic_store_n(&rsrc->options, options & (EVENTS_SEND_ONCE | EVENTS_ALLOW_OVERWRITE), __ATOMIC_RELAXED);
+    __atomic_store_n(&rsrc->task, self, __ATOMIC_RELEASE);
+    return OK;
+}
+
+int eventRsrcStop(EVENTS_RSRC* rsrc) {
+    TASK_ID self = taskIdSelf();
+    if (!rsrc || !self) {
+        errno = EINVAL;
+        return ERROR;
+    }
+    if (__atomic_load_n(&rsrc->task, __ATOMIC_ACQUIRE) != self) {
+        errno = EPERM;
+        return ERROR;
+    }
+    __atomic_store_n(&rsrc->task, (TASK_ID)NULL, __ATOMIC_RELEASE);
+    return OK;
+}
+
+void eventRsrcSend(EVENTS_RSRC* rsrc) {
+    TASK_ID task = __atomic_load_n(&rsrc->task, __ATOMIC_ACQUIRE);
+    if (!task) return;
+    uint32_t events = __atomic_load_n(&rsrc->events, __ATOMIC_RELAXED);
+    if ((__atomic_load_n(&rsrc->options, __ATOMIC_RELAXED) & EVENTS_SEND_ONCE) &&
+        !__atomic_compare_exchange_n(&rsrc->task, &task, (TASK_ID)NULL, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        return;     // another sender used the single shot
+    eventSend(task, events);
+}
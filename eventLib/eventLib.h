@@ -0,0 +1,113 @@
+/**
+ * @file eventLib.h
+ * @brief VxWorks-like task events: a 32-bit event register per task.
+ *
+ * Every task (see taskLib) owns an event register. ::eventSend ORs bits
+ * into another task's register; ::eventReceive waits until all or any of
+ * the wanted bits are set, optionally with a tick timeout. Sending to a
+ * task that is not waiting is one atomic OR and no system call; a waiting
+ * task sleeps on the register itself with a futex.
+ */
+
+#ifndef __INCeventLibh
+#define __INCeventLibh
+
+#include <stdint.h>
+#include "taskLib.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup eventLib Event Library
+ *  @brief Emulation of VxWorks task events.
+ *  @{
+ */
+
+/* User events. As on VxWorks, bits 25-31 are reserved; bit 32 marks a
+   waiting task and cannot be sent. */
+#define VXEV01 0x00000001
+#define VXEV02 0x00000002
+#define VXEV03 0x00000004
+#define VXEV04 0x00000008
+#define VXEV05 0x00000010
+#define VXEV06 0x00000020
+#define VXEV07 0x00000040
+#define VXEV08 0x00000080
+#define VXEV09 0x00000100
+#define VXEV10 0x00000200
+#define VXEV11 0x00000400
+#define VXEV12 0x00000800
+#define VXEV13 0x00001000
+#define VXEV14 0x00002000
+#define VXEV15 0x00004000
+#define VXEV16 0x00008000
+#define VXEV17 0x00010000
+#define VXEV18 0x00020000
+#define VXEV19 0x00040000
+#define VXEV20 0x00080000
+#define VXEV21 0x00100000
+#define VXEV22 0x00200000
+#define VXEV23 0x00400000
+#define VXEV24 0x00800000
+
+#define VXEV_USER_MASK       0x00ffffff
+#define VXEV_RESERVED_MASK   0x7f000000
+
+/* eventReceive options */
+#define EVENTS_WAIT_ALL       0x00  /**< wait until every wanted event arrived */
+#define EVENTS_WAIT_ANY       0x01  /**< wait until one wanted event arrived */
+#define EVENTS_RETURN_ALL     0x02  /**< return (and clear) unwanted events as well */
+#define EVENTS_KEEP_UNWANTED  0x04  /**< leave unwanted events in the register */
+#define EVENTS_FETCH          0x80  /**< return the register at once, clear nothing */
+
+/* Resource registration options (semEvStart, msgQEvStart) */
+#define EVENTS_OPTIONS_NONE     0x00
+#define EVENTS_SEND_ONCE        0x01  /**< unregister after the first send */
+#define EVENTS_ALLOW_OVERWRITE  0x02  /**< let another task take over the registration */
+#define EVENTS_SEND_IF_FREE     0x04  /**< send at once if the resource is already free */
+
+#ifndef WAIT_FOREVER
+#define WAIT_FOREVER (-1)
+#endif
+#ifndef NO_WAIT
+#define NO_WAIT 0
+#endif
+
+/**
+ * @brief Wait for events in the calling task's register.
+ *
+ * When the wait is satisfied, the received wanted events are cleared.
+ * Unwanted events are cleared too unless ::EVENTS_KEEP_UNWANTED is given.
+ *
+ * @param events Wanted events.
+ * @param options EVENTS_* options.
+ * @param timeoutTicks Ticks to wait, ::NO_WAIT or ::WAIT_FOREVER; follows
+ *        tickLib's virtual time.
+ * @param pEventsReceived Receives the events returned (may be NULL). On a
+ *        timeout it holds the wanted events that did arrive, still set in
+ *        the register.
+ * @return OK, or ERROR with errno ETIMEDOUT (timeout) or EAGAIN (NO_WAIT).
+ */
+int eventReceive (uint32_t events, int options, int timeoutTicks, uint32_t *pEventsReceived);
+
+/**
+ * @brief Send events to a task (NULL = the caller).
+ *
+ * @return OK, or ERROR (EINVAL) if @p tid is not a live task or @p events
+ *         contains the waiter bit.
+ */
+int eventSend (TASK_ID tid, uint32_t events);
+
+/**
+ * @brief Clear the calling task's event register.
+ */
+int eventClear (void);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INCeventLibh */
@@ -0,0 +1,88 @@
+/**
+ * @file eventLibDemo.cpp
+ * @brief Demo application for the event library
+ * @details A consumer task waits for any of three events sent by two
+ * producer tasks, then waits for all of them, then times out. Finally the
+ * cost of sending to a task that is not waiting is measured.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include "eventLib.h"
+#include "taskLib.h"
+#include "tickLib.h"
+
+#define EV_DATA    VXEV01
+#define EV_CONFIG  VXEV02
+#define EV_STOP    VXEV03
+
+static TASK_ID g_consumer = NULL;
+
+/**
+ * @brief Sends @p events to the consumer every @p period ticks, @p rounds times
+ */
+static int producer(uintptr_t events, uintptr_t period, uintptr_t rounds,
+                    uintptr_t, uintptr_t, uintptr_t, uintptr_t, uintptr_t, uintptr_t, uintptr_t) {
+    for (uintptr_t i = 0; i < rounds; i++) {
+        taskDelay((int)period);
+        eventSend(g_consumer, (uint32_t)events);
+    }
+    return 0;
+}
+
+static int consumer(uintptr_t, uintptr_t, uintptr_t, uintptr_t, uintptr_t,
+                    uintptr_t, uintptr_t, uintptr_t, uintptr_t, uintptr_t) {
+    uint32_t got = 0;
+
+    printf("--- EVENTS_WAIT_ANY ---\n");
+    for (;;) {
+        eventReceive(EV_DATA | EV_CONFIG | EV_STOP, EVENTS_WAIT_ANY, WAIT_FOREVER, &got);
+        printf("consumer: tick %llu got%s%s%s\n", (unsigned long long)tickGet(),
+               (got & EV_DATA) ? " DATA" : "", (got & EV_CONFIG) ? " CONFIG" : "",
+               (got & EV_STOP) ? " STOP" : "");
+        if (got & EV_STOP) break;
+    }
+
+    printf("\n--- EVENTS_WAIT_ALL ---\n");
+    eventSend(NULL, EV_DATA);
+    eventSend(NULL, EV_CONFIG);
+    if (eventReceive(EV_DATA | EV_CONFIG, EVENTS_WAIT_ALL, 10, &got) == OK)
+        printf("consumer: got DATA and CONFIG together (0x%x)\n", got);
+
+    printf("\n--- Timeout ---\n");
+    eventSend(NULL, EV_DATA);
+    uint64_t t0 = tickGet();
+    if (eventReceive(EV_DATA | EV_CONFIG, EVENTS_WAIT_ALL, 20, &got) == ERROR)
+        printf("consumer: timed out after %llu ticks, had 0x%x\n",
+               (unsigned long long)(tickGet() - t0), got);
+    eventClear();
+    return 0;
+}
+
+int main() {
+    printf("Event Library Example\n");
+    printf("=====================\n\n");
+
+    tickLibInit(100);
+    g_consumer = taskSpawn("tConsumer", 50, 0, 0, consumer, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    taskSpawn("tData", 60, 0, 0, producer, EV_DATA, 5, 4, 0, 0, 0, 0, 0, 0, 0);
+    taskSpawn("tConfig", 60, 0, 0, producer, EV_CONFIG, 12, 1, 0, 0, 0, 0, 0, 0, 0);
+    taskSpawn("tStop", 60, 0, 0, producer, EV_STOP, 30, 1, 0, 0, 0, 0, 0, 0, 0);
+
+    taskDelay(80);
+
+    // cost of a send when the receiver is not waiting: one atomic OR
+    const int N = 1000000;
+    TASK_ID self = taskIdSelf();
+    struct timespec a, b;
+    clock_gettime(CLOCK_MONOTONIC, &a);
+    for (int i = 0; i < N; i++) eventSend(self, EV_DATA);
+    clock_gettime(CLOCK_MONOTONIC, &b);
+    double ns = (double)(b.tv_sec - a.tv_sec) * 1e9 + (double)(b.tv_nsec - a.tv_nsec);
+    printf("\neventSend to a task that is not waiting: %.1f ns\n", ns / N);
+    eventClear();
+
+    tickLibShutdown();
+    printf("\nExample completed\n");
+    return 0;
+}
@@ -0,0 +1,40 @@
+/**
+ * @file eventLibP.h
+ * @brief Private event registration of a resource, for libraries whose
+ *        objects send events (semLib, msgQLib).
+ */
+#ifndef __INCeventLibPh
+#define __INCeventLibPh
+
+#include "eventLib.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* One registered task per resource, as on VxWorks. All fields are atomic:
+   a sender reads them without the resource's lock. */
+typedef struct EVENTS_RSRC {
+    TASK_ID     task;               // registered task, NULL if none
+    uint32_t    events;             // events sent to it
+    int         options;            // EVENTS_SEND_ONCE, EVENTS_ALLOW_OVERWRITE
+} EVENTS_RSRC;
+
+/* Register the caller. Calls on one resource must be serialized by its
+   owner. Fails with EBUSY if another task is registered without
+   EVENTS_ALLOW_OVERWRITE. EVENTS_SEND_IF_FREE is left to the caller, which
+   knows whether the resource is free. */
+int eventRsrcStart(EVENTS_RSRC* rsrc, uint32_t events, int options);
+
+/* Unregister; fails with EPERM unless the caller is the registered task */
+int eventRsrcStop(EVENTS_RSRC* rsrc);
+
+/* Send the registered events, if any; lock-free. A send that races with a
+   stop or re-registration may still reach the previous task once. */
+void eventRsrcSend(EVENTS_RSRC* rsrc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INCeventLibPh */
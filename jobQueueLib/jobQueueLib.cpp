@@ -0,0 +1,477 @@
+
+#include "jobQueueLib.h"
+
+#include <errno.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+/*
+ * Every worker owns one Chase-Lev deque per priority. Only the owner
+ * pushes (at bottom, no atomic read-modify-write); everybody, the owner
+ * included, takes from top with a CAS, so the jobs of one deque start in
+ * posting order. A full deque grows into a new array of twice the size;
+ * old arrays are kept until the queue is deleted, because a thief may
+ * still be reading one.
+ *
+ * Threads that are not workers of the queue post into a worker's inbox,
+ * a mutex-protected array. Workers move whole inboxes into their deques
+ * (their own inbox first, then others' with trylock), swapping the array
+ * with a spare one so the lock is held only for a pointer swap.
+ *
+ * A worker with nothing to do registers in idle, rereads epoch, looks
+ * once more and sleeps on epoch with FUTEX_WAIT. A poster checks idle
+ * after queueing and, if anybody is idle, bumps epoch and wakes one
+ * worker. The seq_cst fence on both sides means either the worker's last
+ * look sees the job or the poster sees the worker.
+ */
+
+#define JQ_MAGIC        0x6a516565u     // JobQueue.magic while the queue lives
+#define JQ_CACHE_LINE   64
+#define JQ_DEQUE_INIT   64              // initial slots per deque, power of two
+#define JQ_INBOX_INIT   64
+
+typedef struct {
+    JOB_FUNC fn;
+    void*    arg;
+} JqJob;
+
+typedef struct JqArray {
+    int64_t         mask;
+    struct JqArray* retired;    // arrays replaced before this one
+    JqJob           slot[];
+} JqArray;
+
+typedef struct {
+    int64_t  top __attribute__((aligned(JQ_CACHE_LINE)));      // taken with CAS by anyone
+    int64_t  bottom __attribute__((aligned(JQ_CACHE_LINE)));   // written by the owner only
+    JqArray* array;
+} JqDeque;
+
+typedef struct {
+    JqJob job;
+    int   prio;
+} JqPost;
+
+struct JobQueue;
+
+typedef struct JqWorker {
+    JqDeque dq[JOB_QUEUE_PRIORITIES];
+
+    // inbox, under inboxLock
+    pthread_mutex_t inboxLock __attribute__((aligned(JQ_CACHE_LINE)));
+    JqPost*  inbox;
+    size_t   inboxCap;
+    uint32_t inboxCount;        // also read without the lock
+    uint32_t inboxPrios;        // bit per priority present; also read without the lock
+    uint64_t inboxPosts;
+
+    // owner only
+    JqPost*   spare __attribute__((aligned(JQ_CACHE_LINE)));
+    size_t    spareCap;
+    uint32_t  rng;
+    struct JobQueue* q;
+    pthread_t thread;
+    uint64_t  run;              // counters: single writer, read by jobQueueShow
+    uint64_t  stolen;
+    uint64_t  localPosts;
+    uint64_t  sleeps;
+} JqWorker;
+
+typedef struct JobQueue {
+    // read-only after create
+    uint32_t  magic;
+    int       nWorkers;
+    JqWorker* workers;
+
+    // sleep / wake
+    uint32_t epoch __attribute__((aligned(JQ_CACHE_LINE)));     // futex word
+    int      idle;
+    int      stopping;
+} JobQueue;
+
+// worker the calling thread is, NULL for other threads
+static __thread JqWorker* t_worker = NULL;
+// round-robin inbox choice of a posting thread
+static __thread uint32_t t_next = 0;
+
+static void jq_futex_wait(uint32_t* word, uint32_t val) {
+    syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+}
+
+static void jq_futex_wake(uint32_t* word, int n) {
+    syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, n, NULL, NULL, 0);
+}
+
+static inline void jq_count(uint64_t* counter) {
+    // single writer; the atomic store only keeps concurrent readers defined
+    __atomic_store_n(counter, *counter + 1, __ATOMIC_RELAXED);
+}
+
+static JobQueue* jq_queue(JOB_QUEUE_ID qId) {
+    JobQueue* q = (JobQueue*)qId;
+    if (!q || q->magic != JQ_MAGIC) {
+        errno = EINVAL;
+        return NULL;
+    }
+    return q;
+}
+
+static JqArray* jq_array_new(int64_t size) {
+    JqArray* a = (JqArray*)malloc(sizeof(JqArray) + (size_t)size * sizeof(JqJob));
+    if (!a) return NULL;
+    a->mask = size - 1;
+    a->retired = NULL;
+    return a;
+}
+
+static inline void jq_slot_put(JqArray* a, int64_t i, const JqJob* job) {
+    JqJob* s = &a->slot[i & a->mask];
+    __atomic_store_n(&s->fn, job->fn, __ATOMIC_RELAXED);
+    __atomic_store_n(&s->arg, job->arg, __ATOMIC_RELAXED);
+}
+
+static inline void jq_slot_get(JqArray* a, int64_t i, JqJob* job) {
+    JqJob* s = &a->slot[i & a->mask];
+    job->fn = __atomic_load_n(&s->fn, __ATOMIC_RELAXED);
+    job->arg = __atomic_load_n(&s->arg, __ATOMIC_RELAXED);
+}
+
+// Owner only. Returns -1 if the deque was full and could not grow.
+static int jq_push(JqDeque* d, const JqJob* job) {
+    int64_t b = d->bottom;
+    int64_t t = __atomic_load_n(&d->top, __ATOMIC_ACQUIRE);
+    JqArray* a = d->array;
+    if (b - t > a->mask) {
+        JqArray* bigger = jq_array_new((a->mask + 1) * 2);
+        if (!bigger) return -1;
+        for (int64_t i = t; i < b; i++) {
+            JqJob tmp;
+            jq_slot_get(a, i, &tmp);
+            jq_slot_put(bigger, i, &tmp);
+        }
+        bigger->retired = a;
+        __atomic_store_n(&d->array, bigger, __ATOMIC_RELEASE);
+        a = bigger;
+    }
+    jq_slot_put(a, b, job);
+    __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+// Any thread. Returns 1 with *job filled, 0 if empty, -1 if another taker won.
+static int jq_take(JqDeque* d, JqJob* job) {
+    int64_t t = __atomic_load_n(&d->top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int64_t b = __atomic_load_n(&d->bottom, __ATOMIC_ACQUIRE);
+    if (t >= b) return 0;
+    JqArray* a = __atomic_load_n(&d->array, __ATOMIC_ACQUIRE);
+    jq_slot_get(a, t, job);
+    if (!__atomic_compare_exchange_n(&d->top, &t, t + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+        return -1;
+    return 1;
+}
+
+static int jq_take_retry(JqDeque* d, JqJob* job) {
+    int rc;
+    while ((rc = jq_take(d, job)) < 0) {
+    }
+    return rc;
+}
+
+static void jq_wake(JobQueue* q) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&q->idle, __ATOMIC_RELAXED) > 0) {
+        __atomic_add_fetch(&q->epoch, 1, __ATOMIC_SEQ_CST);
+        jq_futex_wake(&q->epoch, 1);
+    }
+}
+
+static inline void jq_run(JqWorker* w, const JqJob* job) {
+    job->fn(job->arg);
+    jq_count(&w->run);
+}
+
+// Move the inbox of @from into the deques of @w; returns the number of jobs moved
+static uint32_t jq_drain(JqWorker* w, JqWorker* from, int wait) {
+    if (!__atomic_load_n(&from->inboxCount, __ATOMIC_ACQUIRE)) return 0;
+    if (wait) pthread_mutex_lock(&from->inboxLock);
+    else if (pthread_mutex_trylock(&from->inboxLock) != 0) return 0;
+
+    JqPost* posts = from->inbox;
+    size_t cap = from->inboxCap;
+    uint32_t n = from->inboxCount;
+    from->inbox = w->spare;
+    from->inboxCap = w->spareCap;
+    __atomic_store_n(&from->inboxCount, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&from->inboxPrios, 0, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&from->inboxLock);
+
+    for (uint32_t i = 0; i < n; i++) {
+        // out of memory for a bigger deque: run the job here rather than lose it
+        if (jq_push(&w->dq[posts[i].prio], &posts[i].job) != 0) jq_run(w, &posts[i].job);
+    }
+    w->spare = posts;
+    w->spareCap = cap;
+    return n;
+}
+
+static inline uint32_t jq_rand(JqWorker* w) {
+    uint32_t x = w->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return w->rng = x;
+}
+
+// Find the most urgent job. Level by level: own deque, the others' deques,
+// then any other inbox holding a job of that level, moved into our deques.
+static int jq_find(JqWorker* w, JqJob* job) {
+    JobQueue* q = w->q;
+    int n = q->nWorkers;
+
+    jq_drain(w, w, 1);
+    int start = n > 1 ? (int)(jq_rand(w) % (uint32_t)n) : 0;
+    for (int prio = 0; prio < JOB_QUEUE_PRIORITIES; prio++) {
+        if (jq_take_retry(&w->dq[prio], job)) return 1;
+        for (int i = 0; i < n; i++) {
+            JqWorker* v = &q->workers[(start + i) % n];
+            if (v == w) continue;
+            if (jq_take_retry(&v->dq[prio], job)) {
+                jq_count(&w->stolen);
+                return 1;
+            }
+        }
+        for (int i = 0; i < n; i++) {
+            JqWorker* v = &q->workers[(start + i) % n];
+            if (v == w || !(__atomic_load_n(&v->inboxPrios, __ATOMIC_ACQUIRE) & (1u << prio))) continue;
+            if (jq_drain(w, v, 0) && jq_take_retry(&w->dq[prio], job)) {
+                jq_count(&w->stolen);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+static void* jq_worker(void* p) {
+    JqWorker* w = (JqWorker*)p;
+    JobQueue* q = w->q;
+    t_worker = w;
+
+    JqJob job;
+    for (;;) {
+        if (jq_find(w, &job)) {
+            jq_run(w, &job);
+            continue;
+        }
+        __atomic_add_fetch(&q->idle, 1, __ATOMIC_SEQ_CST);
+        uint32_t epoch = __atomic_load_n(&q->epoch, __ATOMIC_SEQ_CST);
+        int found = jq_find(w, &job);
+        if (!found && __atomic_load_n(&q->stopping, __ATOMIC_SEQ_CST)) {
+            // everything posted before jobQueueDelete is visible now
+            found = jq_find(w, &job);
+            if (!found) {
+                __atomic_sub_fetch(&q->idle, 1, __ATOMIC_RELAXED);
+                break;
+            }
+        }
+        if (!found) {
+            jq_count(&w->sleeps);
+            jq_futex_wait(&q->epoch, epoch);
+        }
+        __atomic_sub_fetch(&q->idle, 1, __ATOMIC_RELAXED);
+        if (found) jq_run(w, &job);
+    }
+    t_worker = NULL;
+    return NULL;
+}
+
+static void jq_free_workers(JobQueue* q, int n) {
+    for (int i = 0; i < n; i++) {
+        JqWorker* w = &q->workers[i];
+        for (int prio = 0; prio < JOB_QUEUE_PRIORITIES; prio++) {
+            JqArray* a = w->dq[prio].array;
+            while (a) {
+                JqArray* next = a->retired;
+                free(a);
+                a = next;
+            }
+        }
+        free(w->inbox);
+        free(w->spare);
+        pthread_mutex_destroy(&w->inboxLock);
+    }
+    free(q->workers);
+}
+
+JOB_QUEUE_ID jobQueueCreate(int nWorkers, int fifoPriority) {
+    if (nWorkers == 0) nWorkers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (nWorkers < 1 || nWorkers > JOB_QUEUE_MAX_WORKERS) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    void* mem = NULL;
+    if (posix_memalign(&mem, JQ_CACHE_LINE, sizeof(JobQueue)) != 0) return NULL;
+    JobQueue* q = (JobQueue*)mem;
+    memset(q, 0, sizeof(*q));
+    if (posix_memalign(&mem, JQ_CACHE_LINE, (size_t)nWorkers * sizeof(JqWorker)) != 0) {
+        free(q);
+        return NULL;
+    }
+    q->workers = (JqWorker*)mem;
+    memset(q->workers, 0, (size_t)nWorkers * sizeof(JqWorker));
+
+    int ready = 0;
+    for (; ready < nWorkers; ready++) {
+        JqWorker* w = &q->workers[ready];
+        pthread_mutex_init(&w->inboxLock, NULL);
+        w->q = q;
+        w->rng = 0x9e3779b9u * (uint32_t)(ready + 1);
+        w->inbox = (JqPost*)malloc(JQ_INBOX_INIT * sizeof(JqPost));
+        w->inboxCap = JQ_INBOX_INIT;
+        w->spare = (JqPost*)malloc(JQ_INBOX_INIT * sizeof(JqPost));
+        w->spareCap = JQ_INBOX_INIT;
+        int ok = w->inbox && w->spare;
+        for (int prio = 0; prio < JOB_QUEUE_PRIORITIES; prio++) {
+            w->dq[prio].array = jq_array_new(JQ_DEQUE_INIT);
+            if (!w->dq[prio].array) ok = 0;
+        }
+        if (!ok) {
+            jq_free_workers(q, ready + 1);
+            free(q);
+            errno = ENOMEM;
+            return NULL;
+        }
+    }
+    q->nWorkers = nWorkers;
+    q->magic = JQ_MAGIC;
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    if (fifoPriority > 0) {
+        // explicit scheduling, so that a refused priority fails the create
+        struct sched_param sp;
+        memset(&sp, 0, sizeof(sp));
+        sp.sched_priority = fifoPriority;
+        pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+        pthread_attr_setschedparam(&attr, &sp);
+    }
+    for (int i = 0; i < nWorkers; i++) {
+        JqWorker* w = &q->workers[i];
+        int rc = pthread_create(&w->thread, &attr, jq_worker, w);
+        if (rc != 0) {
+            pthread_attr_destroy(&attr);
+            // the workers already running serve the whole queue, so just stop them
+            __atomic_store_n(&q->stopping, 1, __ATOMIC_SEQ_CST);
+            __atomic_add_fetch(&q->epoch, 1, __ATOMIC_SEQ_CST);
+            jq_futex_wake(&q->epoch, JOB_QUEUE_MAX_WORKERS);
+            for (int j = 0; j < i; j++) pthread_join(q->workers[j].thread, NULL);
+            q->magic = 0;
+            jq_free_workers(q, nWorkers);
+            free(q);
+            errno = rc;
+            return NULL;
+        }
+    }
+    pthread_attr_destroy(&attr);
+    return q;
+}
+
+int jobQueueDelete(JOB_QUEUE_ID qId) {
+    JobQueue* q = jq_queue(qId);
+    if (!q) return ERROR;
+    if (t_worker && t_worker->q == q) {
+        errno = EDEADLK;
+        return ERROR;
+    }
+
+    __atomic_store_n(&q->stopping, 1, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&q->epoch, 1, __ATOMIC_SEQ_CST);
+    jq_futex_wake(&q->epoch, JOB_QUEUE_MAX_WORKERS);
+    for (int i = 0; i < q->nWorkers; i++) pthread_join(q->workers[i].thread, NULL);
+
+    q->magic = 0;
+    jq_free_workers(q, q->nWorkers);
+    free(q);
+    return OK;
+}
+
+int jobQueuePost(JOB_QUEUE_ID qId, JOB_FUNC fn, void* arg, int prio) {
+    JobQueue* q = jq_queue(qId);
+    if (!q) return ERROR;
+    if (!fn || prio < 0 || prio >= JOB_QUEUE_PRIORITIES) {
+        errno = EINVAL;
+        return ERROR;
+    }
+    JqJob job = { fn, arg };
+
+    JqWorker* w = t_worker;
+    if (w && w->q == q) {
+        if (jq_push(&w->dq[prio], &job) != 0) {
+            errno = ENOMEM;
+            return ERROR;
+        }
+        jq_count(&w->localPosts);
+    } else {
+        if (t_next == 0) t_next = (uint32_t)(uintptr_t)&t_next >> 6 | 1;
+        w = &q->workers[t_next++ % (uint32_t)q->nWorkers];
+
+        pthread_mutex_lock(&w->inboxLock);
+        if (w->inboxCount == w->inboxCap) {
+            JqPost* bigger = (JqPost*)realloc(w->inbox, w->inboxCap * 2 * sizeof(JqPost));
+            if (!bigger) {
+                pthread_mutex_unlock(&w->inboxLock);
+                errno = ENOMEM;
+                return ERROR;
+            }
+            w->inbox = bigger;
+            w->inboxCap *= 2;
+        }
+        w->inbox[w->inboxCount].job = job;
+        w->inbox[w->inboxCount].prio = prio;
+        __atomic_store_n(&w->inboxPrios, w->inboxPrios | (1u << prio), __ATOMIC_RELEASE);
+        __atomic_store_n(&w->inboxCount, w->inboxCount + 1, __ATOMIC_RELEASE);
+        w->inboxPosts++;
+        pthread_mutex_unlock(&w->inboxLock);
+    }
+    jq_wake(q);
+    return OK;
+}
+
+int jobQueueShow(JOB_QUEUE_ID qId) {
+    JobQueue* q = jq_queue(qId);
+    if (!q) return ERROR;
+
+    printf("Job queue %p: %d workers, %d idle\n", (void*)q, q->nWorkers,
+           __atomic_load_n(&q->idle, __ATOMIC_RELAXED));
+    printf("  %6s %8s %12s %12s %12s %12s %10s\n",
+           "WORKER", "QUEUED", "RUN", "STOLEN", "LOCAL POSTS", "INBOX POSTS", "SLEEPS");
+    for (int i = 0; i < q->nWorkers; i++) {
+        JqWorker* w = &q->workers[i];
+        int64_t queued = 0;
+        for (int prio = 0; prio < JOB_QUEUE_PRIORITIES; prio++) {
+            int64_t n = __atomic_load_n(&w->dq[prio].bottom, __ATOMIC_RELAXED) -
+                        __atomic_load_n(&w->dq[prio].top, __ATOMIC_RELAXED);
+            if (n > 0) queued += n;
+        }
+        pthread_mutex_lock(&w->inboxLock);
+        queued += w->inboxCount;
+        uint64_t inboxPosts = w->inboxPosts;
+        pthread_mutex_unlock(&w->inboxLock);
+        printf("  %6d %8lld %12llu %12llu %12llu %12llu %10llu\n", i, (long long)queued,
+               (unsigned long long)__atomic_load_n(&w->run, __ATOMIC_RELAXED),
+               (unsigned long long)__atomic_load_n(&w->stolen, __ATOMIC_RELAXED),
+               (unsigned long long)__atomic_load_n(&w->localPosts, __ATOMIC_RELAXED),
+               (unsigned long long)inboxPosts,
+               (unsigned long long)__atomic_load_n(&w->sleeps, __ATOMIC_RELAXED));
+    }
+    return OK;
+}
@@ -0,0 +1,101 @@
+/**
+ * @file jobQueueLib.h
+ * @brief VxWorks-like job queues: a pool of workers running short jobs,
+ *        with per-worker deques and work stealing.
+ *
+ * A job is a function and an argument. Each worker owns one deque per
+ * priority level. A job posted by a job goes onto its worker's own deque
+ * without a lock; a job posted by any other thread goes into the inbox of
+ * one worker, chosen round-robin per posting thread, so posters do not
+ * share a lock either. An idle worker takes jobs from the other workers'
+ * deques and inboxes before it goes to sleep.
+ *
+ * A worker always runs the most urgent job it can find, and jobs of one
+ * priority posted to one worker start in posting order. Priorities are not
+ * a global order: a worker may start a less urgent job while another
+ * worker still has a more urgent one queued.
+ */
+
+#ifndef __INCjobQueueLibh
+#define __INCjobQueueLibh
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup jobQueueLib Job Queue Library
+ *  @brief Work-stealing job executor.
+ *  @{
+ */
+
+#ifndef OK
+#define OK 0
+#endif
+#ifndef ERROR
+#define ERROR -1
+#endif
+
+typedef void* JOB_QUEUE_ID;
+
+/** A job; runs on one of the queue's workers. */
+typedef void (*JOB_FUNC)(void *arg);
+
+/** Job priorities, 0 (most urgent) to ::JOB_PRIO_LOWEST. */
+#define JOB_QUEUE_PRIORITIES    8
+#define JOB_PRIO_HIGHEST        0
+#define JOB_PRIO_LOWEST         (JOB_QUEUE_PRIORITIES - 1)
+
+/** Largest number of workers in one queue. */
+#define JOB_QUEUE_MAX_WORKERS   64
+
+/**
+ * @brief Create a job queue and start its workers.
+ *
+ * @param nWorkers Number of workers, 0 for one per online CPU; at most
+ *        ::JOB_QUEUE_MAX_WORKERS.
+ * @param fifoPriority SCHED_FIFO priority of the workers, 0 to inherit
+ *        the caller's policy.
+ * @return Queue ID, or NULL on error: errno EINVAL for a bad worker count
+ *         or priority, EPERM if the process may not use SCHED_FIFO (no
+ *         CAP_SYS_NICE), ENOMEM or EAGAIN if resources ran out.
+ */
+JOB_QUEUE_ID jobQueueCreate (int nWorkers, int fifoPriority);
+
+/**
+ * @brief Run every job still queued, stop the workers and free the queue.
+ *
+ * Jobs may keep posting to the queue until they are all done; other
+ * threads must have stopped posting.
+ *
+ * @return OK; ERROR (errno EINVAL) if @p qId is not a job queue, or
+ *         (EDEADLK) if called from one of its jobs.
+ */
+int jobQueueDelete (JOB_QUEUE_ID qId);
+
+/**
+ * @brief Queue @p fn(@p arg) at priority @p prio.
+ *
+ * Any thread may post, including a job of this or another queue.
+ *
+ * @return OK; ERROR with errno EINVAL for a bad queue, NULL @p fn or a
+ *         priority out of range, ENOMEM if the job could not be queued.
+ */
+int jobQueuePost (JOB_QUEUE_ID qId, JOB_FUNC fn, void *arg, int prio);
+
+/**
+ * @brief Print each worker's queued, run, stolen and posted job counts.
+ *
+ * @return OK, or ERROR if @p qId is not a job queue.
+ */
+int jobQueueShow (JOB_QUEUE_ID qId);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INCjobQueueLibh */
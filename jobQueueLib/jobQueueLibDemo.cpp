@@ -0,0 +1,100 @@
+/**
+ * @file jobQueueLibDemo.cpp
+ * @brief Demo application for the job queue library
+ * @details Shows that queued jobs start by priority, splits a sum into
+ * jobs that post their own halves (and get stolen by idle workers), and
+ * measures how fast a queue runs a million tiny jobs posted from main.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include "jobQueueLib.h"
+
+#define TINY_JOBS 1000000
+
+static JOB_QUEUE_ID g_q = NULL;
+static char g_order[32];
+static int g_orderLen = 0;
+static unsigned long long g_sum = 0;
+static unsigned long g_tiny = 0;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Holds the only worker while main queues the other jobs
+ */
+static void gate(void* arg) {
+    (void)arg;
+    usleep(50 * 1000);
+}
+
+/**
+ * @brief Records the priority it was posted at
+ */
+static void record(void* arg) {
+    g_order[g_orderLen++] = (char)('0' + (int)(intptr_t)arg);
+}
+
+/**
+ * @brief Sums [lo, hi) itself when small, else posts both halves
+ */
+static void sum_range(void* arg) {
+    uintptr_t lo = (uintptr_t)arg >> 32, hi = (uintptr_t)arg & 0xffffffffu;
+    if (hi - lo <= 1000) {
+        unsigned long long s = 0;
+        for (uintptr_t i = lo; i < hi; i++) s += i;
+        __atomic_add_fetch(&g_sum, s, __ATOMIC_RELAXED);
+        return;
+    }
+    uintptr_t mid = lo + (hi - lo) / 2;
+    jobQueuePost(g_q, sum_range, (void*)(lo << 32 | mid), JOB_PRIO_LOWEST);
+    jobQueuePost(g_q, sum_range, (void*)(mid << 32 | hi), JOB_PRIO_LOWEST);
+}
+
+static void tiny(void* arg) {
+    (void)arg;
+    __atomic_add_fetch(&g_tiny, 1, __ATOMIC_RELAXED);
+}
+
+int main() {
+    printf("Job Queue Library Example\n");
+    printf("=========================\n\n");
+
+    printf("--- Priorities (one worker) ---\n");
+    g_q = jobQueueCreate(1, 0);
+    jobQueuePost(g_q, gate, NULL, JOB_PRIO_HIGHEST);
+    usleep(10 * 1000);
+    int prios[] = { 7, 3, 7, 0, 5, 0, 3, 7 };
+    for (unsigned i = 0; i < sizeof(prios) / sizeof(prios[0]); i++)
+        jobQueuePost(g_q, record, (void*)(intptr_t)prios[i], prios[i]);
+    jobQueueDelete(g_q);
+    g_order[g_orderLen] = '\0';
+    printf("posted 73705037, started %s\n", g_order);
+
+    printf("\n--- Jobs posting jobs, 4 workers ---\n");
+    g_q = jobQueueCreate(4, 0);
+    uintptr_t n = 10000000;
+    jobQueuePost(g_q, sum_range, (void*)(uintptr_t)n, JOB_PRIO_LOWEST);
+    while (__atomic_load_n(&g_sum, __ATOMIC_RELAXED) != (unsigned long long)n * (n - 1) / 2)
+        usleep(1000);
+    printf("sum of 0..%lu = %llu\n", (unsigned long)(n - 1), g_sum);
+    jobQueueShow(g_q);
+    jobQueueDelete(g_q);
+
+    printf("\n--- %d tiny jobs posted from main ---\n", TINY_JOBS);
+    g_q = jobQueueCreate(0, 0);
+    double t0 = now_sec();
+    for (int i = 0; i < TINY_JOBS; i++)
+        jobQueuePost(g_q, tiny, NULL, i % JOB_QUEUE_PRIORITIES);
+    jobQueueDelete(g_q);
+    double sec = now_sec() - t0;
+    printf("%lu jobs run in %.3f s, %.0f ns per job\n", g_tiny, sec, sec * 1e9 / TINY_JOBS);
+
+    printf("\nExample completed\n");
+    return 0;
+}
@@ -7,9 +7,16 @@
 #include <stdlib.h>
 #include <string.h>
 
+/* Weak: memPartLib is linked only by programs using mboxCreatePart, and a
+   non-NULL part can only have come from it. */
+extern "C" {
+void* memPartAlloc(PART_ID partId, size_t nBytes) __attribute__((weak));
+int   memPartFree(PART_ID partId, void* pBlock) __attribute__((weak));
+}
+
 typedef struct MsgNode {
     size_t len;
-    unsigned char* data;
+    unsigned char* data;       // follows the node in the same allocation
     struct MsgNode* next;
 } MsgNode;
 
@@ -26,8 +33,18 @@ typedef struct Mbox {
     size_t waiterRecv;
     MsgNode* head;
     MsgNode* tail;
+    PART_ID part;              // memory partition for the mailbox and its messages, NULL = heap
 } Mbox;
 
+static void* mbox_alloc(PART_ID part, size_t n) {
+    return part ? memPartAlloc(part, n) : malloc(n);
+}
+
+static void mbox_free(PART_ID part, void* p) {
+    if (part) memPartFree(part, p);
+    else free(p);
+}
+
 static int add_ms_to_timespec(struct timespec* ts, unsigned long long ms) {
     const long NS_PER_MS = 1000000L;
     ts->tv_nsec += (long)(ms % 1000ULL) * NS_PER_MS;
@@ -39,6 +56,115 @@ static int add_ms_to_timespec(struct timespec* ts, unsigned long long ms) {
     return 0;
 }
 
+// A task blocked in a timed wait while tickLib runs virtual time. Once the
+// virtual count reaches expiry, the tick hook locks the waiter's mutex,
+// marks the wait timed out unless its predicate already holds, and
+// broadcasts the condition variable, so the tickAdvance() call that reaches
+// the timeout decides it.
+typedef struct MboxVirtWaiter {
+    pthread_cond_t* cv;
+    pthread_mutex_t* mtx;
+    int (*pred)(void*);
+    void* ctx;
+    uint64_t expiry;
+    int linked;     // on g_virtWaiters; cleared by the hook when it expires the wait
+    int timedOut;   // set by the hook under mtx
+    struct MboxVirtWaiter* prev;
+    struct MboxVirtWaiter* next;
+} MboxVirtWaiter;
+
+static pthread_mutex_t g_virtLock = PTHREAD_MUTEX_INITIALIZER;
+static MboxVirtWaiter* g_virtWaiters = NULL;   // under g_virtLock
+static int g_virtCount = 0;                 // waiters listed; read without the lock
+// Serializes tickHookAdd/Delete. Neither lock is taken with a mailbox mutex
+// held: the hook takes g_virtLock and then mailbox mutexes, and tickHookDelete
+// waits for running hooks.
+static pthread_mutex_t g_virtHookLock = PTHREAD_MUTEX_INITIALIZER;
+static int g_virtHookUsers = 0;
+
+static void mbox_virt_unlink_locked(MboxVirtWaiter* w) {
+    if (w->prev) w->prev->next = w->next;
+    else g_virtWaiters = w->next;
+    if (w->next) w->next->prev = w->prev;
+    w->linked = 0;
+    __atomic_sub_fetch(&g_virtCount, 1, __ATOMIC_SEQ_CST);
+}
+
+// Tick hook: times out the virtual-time waits whose expiry was reached
+static void mbox_virt_tick_hook(uint64_t tick, void* arg) {
+    (void)arg;
+    if (!__atomic_load_n(&g_virtCount, __ATOMIC_SEQ_CST)) return;
+    pthread_mutex_lock(&g_virtLock);
+    MboxVirtWaiter* w = g_virtWaiters;
+    while (w) {
+        MboxVirtWaiter* next = w->next;   // w may return once its mutex is released
+        if (tick >= w->expiry) {
+            pthread_mutex_lock(w->mtx);
+            if (!w->pred(w->ctx)) w->timedOut = 1;
+            mbox_virt_unlink_locked(w);
+            pthread_cond_broadcast(w->cv);
+            pthread_mutex_unlock(w->mtx);
+        }
+        w = next;
+    }
+    pthread_mutex_unlock(&g_virtLock);
+}
+
+static void mbox_virt_link(MboxVirtWaiter* w) {
+    pthread_mutex_lock(&g_virtHookLock);
+    if (g_virtHookUsers++ == 0) tickHookAdd(mbox_virt_tick_hook, NULL);
+    pthread_mutex_unlock(&g_virtHookLock);
+
+    pthread_mutex_lock(&g_virtLock);
+    w->prev = NULL;
+    w->next = g_virtWaiters;
+    if (w->next) w->next->prev = w;
+    g_virtWaiters = w;
+    w->linked = 1;
+    __atomic_add_fetch(&g_virtCount, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&g_virtLock);
+}
+
+static void mbox_virt_unlink(MboxVirtWaiter* w) {
+    pthread_mutex_lock(&g_virtLock);
+    if (w->linked) mbox_virt_unlink_locked(w);
+    pthread_mutex_unlock(&g_virtLock);
+
+    pthread_mutex_lock(&g_virtHookLock);
+    if (--g_virtHookUsers == 0) tickHookDelete(mbox_virt_tick_hook, NULL);
+    pthread_mutex_unlock(&g_virtHookLock);
+}
+
+// Timed wait in virtual time (caller holds mtx). The waiter is listed for
+// the tick hook with mtx released, so a predicate that held when it woke is
+// checked again once it is unlisted.
+static int wait_pred_virtual(pthread_cond_t* cv, pthread_mutex_t* mtx,
+                             int timeoutTicks, int (*pred)(void*), void* ctx) {
+    MboxVirtWaiter w;
+    w.cv = cv;
+    w.mtx = mtx;
+    w.pred = pred;
+    w.ctx = ctx;
+    w.expiry = tickGet() + (uint64_t)timeoutTicks;
+
+    int ready = pred(ctx);
+    while (!ready && tickGet() < w.expiry) {
+        w.timedOut = 0;
+        pthread_mutex_unlock(mtx);
+        mbox_virt_link(&w);
+        pthread_mutex_lock(mtx);
+        while (!pred(ctx) && !w.timedOut && tickGet() < w.expiry) {
+            pthread_cond_wait(cv, mtx);
+        }
+        pthread_mutex_unlock(mtx);
+        mbox_virt_unlink(&w);
+        pthread_mutex_lock(mtx);
+        if (w.timedOut) return 0;
+        ready = pred(ctx);
+    }
+    return ready;
+}
+
 static int wait_pred_with_timeout(pthread_cond_t* cv, pthread_mutex_t* mtx,
                                   int timeoutTicks, int (*pred)(void*), void* ctx,
                                   size_t* waiterCounter, pthread_cond_t* drain) {
@@ -52,6 +178,8 @@ static int wait_pred_with_timeout(pthread_cond_t* cv, pthread_mutex_t* mtx,
         while (!(ready = pred(ctx))) {
             pthread_cond_wait(cv, mtx);
         }
+    } else if (tickVirtualModeGet()) {
+        ready = wait_pred_virtual(cv, mtx, timeoutTicks, pred, ctx);
     } else {
         int tps = sysClkRateGet(); if (tps <= 0) tps = 60;
         unsigned long long ms = ((unsigned long long)timeoutTicks * 1000ULL) / (unsigned long long)tps;
@@ -72,6 +200,15 @@ static int wait_pred_with_timeout(pthread_cond_t* cv, pthread_mutex_t* mtx,
     return ready;
 }
 
+// Condition variables time out against CLOCK_MONOTONIC deadlines
+static void cond_init_monotonic(pthread_cond_t* cv) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cv, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
 static int pred_can_send(void* ctx) {
     Mbox* m = (Mbox*)ctx;
     return !m->valid ? 1 : (m->count < m->maxMsgs);
@@ -82,14 +219,16 @@ static int pred_has_data(void* ctx) {
     return !m->valid ? 1 : (m->count > 0);
 }
 
-MBOX_ID mboxCreate(size_t maxMsgs, size_t maxMsgLen) {
+MBOX_ID mboxCreatePart(size_t maxMsgs, size_t maxMsgLen, PART_ID part) {
     if (maxMsgs == 0 || maxMsgLen == 0) return NULL;
-    Mbox* m = (Mbox*)calloc(1, sizeof(Mbox));
+    Mbox* m = (Mbox*)mbox_alloc(part, sizeof(Mbox));
     if (!m) return NULL;
+    memset(m, 0, sizeof(Mbox));
+    m->part    = part;
     pthread_mutex_init(&m->mtx, NULL);
-    pthread_cond_init(&m->canSend, NULL);
-    pthread_cond_init(&m->canRecv, NULL);
-    pthread_cond_init(&m->drain, NULL);
+    cond_init_monotonic(&m->canSend);
+    cond_init_monotonic(&m->canRecv);
+    cond_init_monotonic(&m->drain);
     m->maxMsgs = maxMsgs;
     m->maxLen  = maxMsgLen;
     m->valid   = 1;
@@ -97,6 +236,10 @@ MBOX_ID mboxCreate(size_t maxMsgs, size_t maxMsgLen) {
     return m;
 }
 
+MBOX_ID mboxCreate(size_t maxMsgs, size_t maxMsgLen) {
+    return mboxCreatePart(maxMsgs, maxMsgLen, NULL);
+}
+
 int mboxDelete(MBOX_ID id) {
     if (!id) return -1;
     Mbox* m = (Mbox*)id;
@@ -116,8 +259,7 @@ int mboxDelete(MBOX_ID id) {
 
     while (n) {
         MsgNode* next = n->next;
-        free(n->data);
-        free(n);
+        mbox_free(m->part, n);
         n = next;
     }
 
@@ -125,7 +267,7 @@ int mboxDelete(MBOX_ID id) {
     pthread_cond_destroy(&m->canRecv);
     pthread_cond_destroy(&m->canSend);
     pthread_mutex_destroy(&m->mtx);
-    free(m);
+    mbox_free(m->part, m);
     return 0;
 }
 
@@ -142,9 +284,10 @@ int mboxSend(MBOX_ID id, const void* data, size_t len, int timeoutTicks) {
     if (!m->valid || m->count >= m->maxMsgs) { pthread_mutex_unlock(&m->mtx); return -1; }
 
     size_t copyLen = len > m->maxLen ? m->maxLen : len;
-    MsgNode* node = (MsgNode*)malloc(sizeof(MsgNode));
+    MsgNode* node = (MsgNode*)mbox_alloc(m->part, sizeof(MsgNode) + copyLen);
+    if (!node) { pthread_mutex_unlock(&m->mtx); return -1; }
     node->len = copyLen;
-    node->data = (unsigned char*)malloc(copyLen ? copyLen : 1);
+    node->data = (unsigned char*)(node + 1);
     if (copyLen && data) memcpy(node->data, data, copyLen);
     node->next = NULL;
 
@@ -182,7 +325,6 @@ int mboxReceive(MBOX_ID id, void* buf, size_t maxLen, size_t* outLen, int timeou
     pthread_cond_signal(&m->canSend);
     pthread_mutex_unlock(&m->mtx);
 
-    free(node->data);
-    free(node);
+    mbox_free(m->part, node);
     return 0;
 }
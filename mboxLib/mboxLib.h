@@ -14,8 +14,15 @@ extern "C" {
 
 typedef void* MBOX_ID;
 
+#ifndef __PART_ID_DEFINED
+#define __PART_ID_DEFINED
+typedef void* PART_ID;      /* memPartLib partition, see mboxCreatePart */
+#endif
+
 /* Create a mailbox with capacity maxMsgs and max message length */
 MBOX_ID mboxCreate(size_t maxMsgs, size_t maxMsgLen);
+/* Same, allocating the mailbox and every message from partition `part` (NULL = heap) */
+MBOX_ID mboxCreatePart(size_t maxMsgs, size_t maxMsgLen, PART_ID part);
 /* Delete a mailbox. Safe: wakes waiters and waits for them to leave. */
 int mboxDelete(MBOX_ID);
 /* Send a message with timeout in ticks (0 poll, <0 forever). Returns 0 or -1 */
@@ -0,0 +1,536 @@
+
+#include "memPartLib.h"
+
+#include <pthread.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+
+/*
+ * Layout: the MemPart control block sits at the (64-byte aligned) start of
+ * the pool; everything after it is handed out. Every block starts with a
+ * 16-byte MemBlock header. Class blocks are carved in runs and never merged
+ * again; they move between a thread's cache and the partition's per-class
+ * list in batches. Large blocks and the thread caches themselves are
+ * carved from the free extent list or, failing that, from the top of the
+ * pool, and go back to the extent list when freed.
+ */
+
+#define MEM_PART_MAGIC      0x6d506172u     // MemPart.magic while the partition lives
+#define MEM_BLOCK_ALLOC     0xa110c8edu     // MemBlock.magic of an allocated block
+#define MEM_BLOCK_FREE      0xf4eeb10cu     // MemBlock.magic of a free block
+#define MEM_CLASS_LARGE     0xffffffffu     // MemBlock.cls of a large block
+#define MEM_ALIGN           16
+#define MEM_CACHE_LINE      64
+#define MEM_BATCH_BYTES     8192            // bytes moved per cache refill/flush
+
+// payload sizes; a class block is its payload plus the header
+static const uint32_t g_classSize[MEM_PART_CLASSES] = {
+    16, 32, 48, 64, 80, 96, 112, 128,
+    160, 192, 224, 256, 320, 384, 448, 512,
+    640, 768, 896, 1024, 1280, 1536, 1792, 2048,
+    2560, 3072, 3584, 4096, 5120, 6144, 7168, 8192
+};
+
+typedef struct MemBlock {
+    uint32_t magic;
+    uint32_t cls;               // size class or MEM_CLASS_LARGE
+    size_t   size;              // block bytes including this header
+} MemBlock;
+
+typedef struct MemExtent {
+    size_t size;
+    struct MemExtent* next;     // address order
+} MemExtent;
+
+typedef struct MemSlot {
+    MemBlock* head;             // free blocks, linked through their payload
+    uint32_t  count;            // atomic for readers
+    uint64_t  allocs;           // atomic for readers
+    uint64_t  frees;            // atomic for readers
+} MemSlot;
+
+// per-thread cache, carved from the pool on the thread's first use
+typedef struct MemCache {
+    struct MemCache* next;      // on MemPart.caches
+    struct MemPart* part;
+    void*   raw;                // carved address and size, for release
+    size_t  rawSize;
+    MemSlot slot[MEM_PART_CLASSES];
+} MemCache;
+
+typedef struct MemPart {
+    // read-only after create
+    uint32_t magic;
+    int      ownPool;           // pool was mmap()ed by memPartCreate
+    uint32_t gen;               // tells a partition from an earlier one at the same address
+    pthread_key_t key;          // MemCache of the calling thread
+    char*    poolMem;
+    size_t   poolSize;
+    char*    base;
+    char*    end;
+    uint32_t batch[MEM_PART_CLASSES];
+
+    // under lock
+    pthread_mutex_t lock __attribute__((aligned(MEM_CACHE_LINE)));
+    char*      top;
+    size_t     highWater;
+    MemExtent* extents;
+    MemCache*  caches;
+    struct {
+        MemBlock* head;
+        size_t    count;
+        size_t    carved;
+        uint64_t  allocs;       // of threads that have exited
+        uint64_t  frees;
+    } cls[MEM_PART_CLASSES];
+    size_t   largeBlocks;
+    size_t   largeBytes;
+    uint64_t failures;          // atomic
+} MemPart;
+
+static uint32_t g_partGen = 0;
+
+// last partition used by this thread, to skip pthread_getspecific
+static __thread MemPart*  t_part = NULL;
+static __thread uint32_t  t_partGen = 0;
+static __thread MemCache* t_cache = NULL;
+
+static inline MemBlock* mem_next(MemBlock* b) {
+    return *(MemBlock**)(b + 1);
+}
+
+static inline void mem_set_next(MemBlock* b, MemBlock* next) {
+    *(MemBlock**)(b + 1) = next;
+}
+
+static inline size_t mem_round(size_t n, size_t to) {
+    return (n + to - 1) & ~(to - 1);
+}
+
+static inline unsigned mem_class(size_t n) {
+    if (n <= 128) return n ? (unsigned)((n + 15) / 16 - 1) : 0;
+    unsigned g = 63 - (unsigned)__builtin_clzll((unsigned long long)(n - 1)) - 7;
+    size_t base = (size_t)128 << g;
+    return 8 + g * 4 + (unsigned)((n - 1 - base) / (base / 4));
+}
+
+static inline void mem_count(uint64_t* counter, int64_t delta) {
+    // single writer; the atomic store only keeps concurrent readers defined
+    __atomic_store_n(counter, *counter + (uint64_t)delta, __ATOMIC_RELAXED);
+}
+
+static MemPart* mem_part(PART_ID partId) {
+    MemPart* p = (MemPart*)partId;
+    if (!p || p->magic != MEM_PART_MAGIC) {
+        errno = EINVAL;
+        return NULL;
+    }
+    return p;
+}
+
+// Take @bytes (a multiple of MEM_ALIGN) from the first extent that fits,
+// else from the top of the pool. *pGot receives the bytes actually taken,
+// which can exceed @bytes by a tail too small to stay on the list.
+static void* mem_carve_locked(MemPart* p, size_t bytes, size_t* pGot) {
+    for (MemExtent** pp = &p->extents; *pp; pp = &(*pp)->next) {
+        MemExtent* e = *pp;
+        if (e->size < bytes) continue;
+        if (e->size - bytes >= sizeof(MemExtent) + MEM_ALIGN) {
+            e->size -= bytes;   // take the tail, the extent stays linked
+            *pGot = bytes;
+            return (char*)e + e->size;
+        }
+        *pp = e->next;
+        *pGot = e->size;
+        return e;
+    }
+    if ((size_t)(p->end - p->top) < bytes) return NULL;
+    void* m = p->top;
+    p->top += bytes;
+    if ((size_t)(p->top - p->base) > p->highWater) p->highWater = (size_t)(p->top - p->base);
+    *pGot = bytes;
+    return m;
+}
+
+// Give memory back: merge it with its neighbours, or lower the top.
+static void mem_release_locked(MemPart* p, void* mem, size_t bytes) {
+    char* lo = (char*)mem;
+    MemExtent** pp = &p->extents;
+    MemExtent* prev = NULL;
+    while (*pp && (char*)*pp < lo) {
+        prev = *pp;
+        pp = &(*pp)->next;
+    }
+    MemExtent* next = *pp;
+    if (next && lo + bytes == (char*)next) {    // merge with the following extent
+        bytes += next->size;
+        next = next->next;
+    }
+    if (prev && (char*)prev + prev->size == lo) {   // merge into the preceding one
+        prev->size += bytes;
+        prev->next = next;
+    } else {
+        MemExtent* e = (MemExtent*)lo;
+        e->size = bytes;
+        e->next = next;
+        *pp = e;
+        prev = e;
+    }
+    if (!prev->next && (char*)prev + prev->size == p->top) {
+        // the last extent touches the top: hand it back to the bump area
+        p->top = (char*)prev;
+        MemExtent** q = &p->extents;
+        while (*q != prev) q = &(*q)->next;
+        *q = NULL;
+    }
+}
+
+static void mem_cache_exit(void* arg) {
+    MemCache* c = (MemCache*)arg;
+    MemPart* p = c->part;
+    if (t_cache == c) t_part = NULL;    // later destructors may still free blocks
+    pthread_mutex_lock(&p->lock);
+    for (unsigned i = 0; i < MEM_PART_CLASSES; i++) {
+        MemSlot* s = &c->slot[i];
+        while (s->head) {
+            MemBlock* b = s->head;
+            s->head = mem_next(b);
+            mem_set_next(b, p->cls[i].head);
+            p->cls[i].head = b;
+            p->cls[i].count++;
+        }
+        p->cls[i].allocs += s->allocs;
+        p->cls[i].frees += s->frees;
+    }
+    MemCache** pp = &p->caches;
+    while (*pp != c) pp = &(*pp)->next;
+    *pp = c->next;
+    mem_release_locked(p, c->raw, c->rawSize);
+    pthread_mutex_unlock(&p->lock);
+}
+
+static MemCache* mem_cache_self(MemPart* p) {
+    if (t_part == p && t_partGen == p->gen) return t_cache;
+    MemCache* c = (MemCache*)pthread_getspecific(p->key);
+    if (c) {
+        t_part = p;
+        t_partGen = p->gen;
+        t_cache = c;
+        return c;
+    }
+
+    size_t got = 0;
+    pthread_mutex_lock(&p->lock);
+    void* raw = mem_carve_locked(p, mem_round(sizeof(MemCache) + MEM_CACHE_LINE, MEM_ALIGN), &got);
+    if (raw) {
+        // own cache line(s), so two threads' caches never share one
+        c = (MemCache*)mem_round((uintptr_t)raw, MEM_CACHE_LINE);
+        memset(c, 0, sizeof(*c));
+        c->part = p;
+        c->raw = raw;
+        c->rawSize = got;
+        c->next = p->caches;
+        p->caches = c;
+    }
+    pthread_mutex_unlock(&p->lock);
+    if (c) {
+        pthread_setspecific(p->key, c);
+        t_part = p;
+        t_partGen = p->gen;
+        t_cache = c;
+    }
+    return c;
+}
+
+// Fill an empty slot with up to one batch: from the class list, else a new run.
+static int mem_refill(MemPart* p, MemSlot* s, unsigned cls) {
+    uint32_t want = p->batch[cls];
+    uint32_t n = 0;
+    MemBlock* head = NULL;
+
+    pthread_mutex_lock(&p->lock);
+    while (n < want && p->cls[cls].head) {
+        MemBlock* b = p->cls[cls].head;
+        p->cls[cls].head = mem_next(b);
+        mem_set_next(b, head);
+        head = b;
+        n++;
+    }
+    p->cls[cls].count -= n;
+    if (n == 0) {
+        size_t bs = g_classSize[cls] + sizeof(MemBlock);
+        size_t got = 0;
+        char* run = NULL;
+        for (uint32_t k = want; k > 0 && !run; k /= 2) {
+            if ((run = (char*)mem_carve_locked(p, k * bs, &got))) n = (uint32_t)(got / bs);
+        }
+        // a whole extent can exceed the run by less than a block; give that back
+        // (all sizes are multiples of MEM_ALIGN, so it holds a MemExtent)
+        if (run && got > (size_t)n * bs) mem_release_locked(p, run + (size_t)n * bs, got - (size_t)n * bs);
+        for (uint32_t i = 0; i < n; i++) {
+            MemBlock* b = (MemBlock*)(run + i * bs);
+            b->magic = MEM_BLOCK_FREE;
+            b->cls = cls;
+            b->size = bs;
+            mem_set_next(b, head);
+            head = b;
+        }
+        p->cls[cls].carved += n;
+    }
+    pthread_mutex_unlock(&p->lock);
+
+    s->head = head;
+    __atomic_store_n(&s->count, n, __ATOMIC_RELAXED);
+    return n > 0;
+}
+
+// Keep the first @keep (most recently freed) blocks, move the rest to the class list.
+static void mem_flush(MemPart* p, MemSlot* s, unsigned cls, uint32_t keep) {
+    MemBlock* last = s->head;
+    for (uint32_t i = 1; i < keep; i++) last = mem_next(last);
+    MemBlock* first = mem_next(last);
+    MemBlock* tail = first;
+    uint32_t n = 1;
+    while (mem_next(tail)) {
+        tail = mem_next(tail);
+        n++;
+    }
+    mem_set_next(last, NULL);
+    __atomic_store_n(&s->count, keep, __ATOMIC_RELAXED);
+
+    pthread_mutex_lock(&p->lock);
+    mem_set_next(tail, p->cls[cls].head);
+    p->cls[cls].head = first;
+    p->cls[cls].count += n;
+    pthread_mutex_unlock(&p->lock);
+}
+
+static void* mem_large_alloc(MemPart* p, size_t nBytes) {
+    size_t got = 0;
+    MemBlock* b = NULL;
+    if (nBytes <= (size_t)(p->end - p->base)) {
+        size_t bytes = mem_round(nBytes, MEM_ALIGN) + sizeof(MemBlock);
+        pthread_mutex_lock(&p->lock);
+        b = (MemBlock*)mem_carve_locked(p, bytes, &got);
+        if (b) {
+            p->largeBlocks++;
+            p->largeBytes += got;
+        }
+        pthread_mutex_unlock(&p->lock);
+    }
+    if (!b) {
+        __atomic_fetch_add(&p->failures, 1, __ATOMIC_RELAXED);
+        errno = ENOMEM;
+        return NULL;
+    }
+    b->magic = MEM_BLOCK_ALLOC;
+    b->cls = MEM_CLASS_LARGE;
+    b->size = got;
+    return b + 1;
+}
+
+PART_ID memPartCreate(char* pPool, size_t poolSize) {
+    char* mem = pPool;
+    if (!mem) {
+        mem = (char*)mmap(NULL, poolSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem == (char*)MAP_FAILED) return NULL;
+    }
+    MemPart* p = (MemPart*)mem_round((uintptr_t)mem, MEM_CACHE_LINE);
+    char* base = (char*)mem_round((uintptr_t)(p + 1), MEM_CACHE_LINE);
+    char* end = (char*)((uintptr_t)(mem + poolSize) & ~(uintptr_t)(MEM_ALIGN - 1));
+    if (poolSize < sizeof(MemPart) + 2 * MEM_CACHE_LINE || base + sizeof(MemCache) + MEM_CACHE_LINE > end) {
+        if (!pPool) munmap(mem, poolSize);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    memset(p, 0, sizeof(*p));
+    if (pthread_key_create(&p->key, mem_cache_exit) != 0) {
+        if (!pPool) munmap(mem, poolSize);
+        errno = EAGAIN;
+        return NULL;
+    }
+    pthread_mutex_init(&p->lock, NULL);
+    p->ownPool = pPool == NULL;
+    p->gen = __atomic_add_fetch(&g_partGen, 1, __ATOMIC_RELAXED);
+    p->poolMem = mem;
+    p->poolSize = poolSize;
+    p->base = p->top = base;
+    p->end = end;
+    for (unsigned i = 0; i < MEM_PART_CLASSES; i++) {
+        uint32_t n = MEM_BATCH_BYTES / (g_classSize[i] + (uint32_t)sizeof(MemBlock));
+        p->batch[i] = n < 2 ? 2 : (n > 32 ? 32 : n);
+    }
+    __atomic_store_n(&p->magic, MEM_PART_MAGIC, __ATOMIC_RELEASE);
+    return p;
+}
+
+int memPartDelete(PART_ID partId) {
+    MemPart* p = mem_part(partId);
+    if (!p) return ERROR;
+    p->magic = 0;
+    pthread_key_delete(p->key);     // thread caches live in the pool, nothing to free
+    pthread_mutex_destroy(&p->lock);
+    if (p->ownPool) munmap(p->poolMem, p->poolSize);
+    return OK;
+}
+
+void* memPartAlloc(PART_ID partId, size_t nBytes) {
+    MemPart* p = mem_part(partId);
+    if (!p) return NULL;
+    if (nBytes > MEM_PART_SMALL_MAX) return mem_large_alloc(p, nBytes);
+
+    unsigned cls = mem_class(nBytes);
+    MemCache* c = mem_cache_self(p);
+    if (!c || (!c->slot[cls].head && !mem_refill(p, &c->slot[cls], cls))) {
+        __atomic_fetch_add(&p->failures, 1, __ATOMIC_RELAXED);
+        errno = ENOMEM;
+        return NULL;
+    }
+    MemSlot* s = &c->slot[cls];
+    MemBlock* b = s->head;
+    s->head = mem_next(b);
+    __atomic_store_n(&s->count, s->count - 1, __ATOMIC_RELAXED);
+    mem_count(&s->allocs, 1);
+    b->magic = MEM_BLOCK_ALLOC;
+    return b + 1;
+}
+
+int memPartFree(PART_ID partId, void* pBlock) {
+    MemPart* p = mem_part(partId);
+    if (!p) return ERROR;
+    if (!pBlock) return OK;
+
+    MemBlock* b = (MemBlock*)pBlock - 1;
+    if ((char*)b < p->base || (char*)pBlock >= p->end || ((uintptr_t)pBlock & (MEM_ALIGN - 1)) ||
+        b->magic != MEM_BLOCK_ALLOC || (b->cls >= MEM_PART_CLASSES && b->cls != MEM_CLASS_LARGE)) {
+        errno = EINVAL;
+        return ERROR;
+    }
+    b->magic = MEM_BLOCK_FREE;
+
+    if (b->cls == MEM_CLASS_LARGE) {
+        pthread_mutex_lock(&p->lock);
+        p->largeBlocks--;
+        p->largeBytes -= b->size;
+        mem_release_locked(p, b, b->size);
+        pthread_mutex_unlock(&p->lock);
+        return OK;
+    }
+
+    unsigned cls = b->cls;
+    MemCache* c = mem_cache_self(p);
+    if (!c) {
+        // no room for a cache: straight to the class list
+        pthread_mutex_lock(&p->lock);
+        mem_set_next(b, p->cls[cls].head);
+        p->cls[cls].head = b;
+        p->cls[cls].count++;
+        p->cls[cls].frees++;
+        pthread_mutex_unlock(&p->lock);
+        return OK;
+    }
+    MemSlot* s = &c->slot[cls];
+    mem_set_next(b, s->head);
+    s->head = b;
+    __atomic_store_n(&s->count, s->count + 1, __ATOMIC_RELAXED);
+    mem_count(&s->frees, 1);
+    if (s->count >= 2 * p->batch[cls]) mem_flush(p, s, cls, p->batch[cls]);
+    return OK;
+}
+
+// Per-class totals over the class list, the exited threads and all live caches.
+typedef struct MemClassInfo {
+    size_t   inUse;
+    size_t   free;
+    size_t   cached;
+    size_t   carved;
+    uint64_t allocs;
+} MemClassInfo;
+
+static void mem_collect_locked(MemPart* p, MemClassInfo info[MEM_PART_CLASSES]) {
+    for (unsigned i = 0; i < MEM_PART_CLASSES; i++) {
+        uint64_t allocs = p->cls[i].allocs, frees = p->cls[i].frees;
+        size_t cached = 0;
+        for (MemCache* c = p->caches; c; c = c->next) {
+            allocs += __atomic_load_n(&c->slot[i].allocs, __ATOMIC_RELAXED);
+            frees += __atomic_load_n(&c->slot[i].frees, __ATOMIC_RELAXED);
+            cached += __atomic_load_n(&c->slot[i].count, __ATOMIC_RELAXED);
+        }
+        int64_t inUse = (int64_t)(allocs - frees);    // a racing thread can make it dip below 0
+        info[i].inUse = inUse > 0 ? (size_t)inUse : 0;
+        info[i].free = p->cls[i].count;
+        info[i].cached = cached;
+        info[i].carved = p->cls[i].carved;
+        info[i].allocs = allocs;
+    }
+}
+
+int memPartInfoGet(PART_ID partId, MEM_PART_STATS* pStats) {
+    MemPart* p = mem_part(partId);
+    if (!p || !pStats) return ERROR;
+
+    MemClassInfo info[MEM_PART_CLASSES];
+    memset(pStats, 0, sizeof(*pStats));
+    pthread_mutex_lock(&p->lock);
+    mem_collect_locked(p, info);
+    size_t top = (size_t)(p->end - p->top);
+    size_t largest = top;
+    for (MemExtent* e = p->extents; e; e = e->next) {
+        pStats->numBytesFree += e->size;
+        pStats->numBlocksFree++;
+        if (e->size > largest) largest = e->size;
+    }
+    pStats->numBytesFree += top;
+    pStats->numBlocksAlloc = p->largeBlocks;
+    pStats->numBytesAlloc = p->largeBytes;
+    pStats->maxBytesAlloc = p->highWater;
+    pthread_mutex_unlock(&p->lock);
+
+    pStats->maxBlockSizeFree = largest > sizeof(MemBlock) ? largest - sizeof(MemBlock) : 0;
+    for (unsigned i = 0; i < MEM_PART_CLASSES; i++) {
+        size_t bs = g_classSize[i] + sizeof(MemBlock);
+        size_t freeBlocks = info[i].free + info[i].cached;
+        pStats->numBlocksFree += freeBlocks;
+        pStats->numBytesFree += freeBlocks * bs;
+        pStats->numBlocksAlloc += info[i].inUse;
+        pStats->numBytesAlloc += info[i].inUse * bs;
+        if (freeBlocks && g_classSize[i] > pStats->maxBlockSizeFree) pStats->maxBlockSizeFree = g_classSize[i];
+    }
+    return OK;
+}
+
+int memPartShow(PART_ID partId, int type) {
+    MemPart* p = mem_part(partId);
+    if (!p) return ERROR;
+
+    MEM_PART_STATS st;
+    memPartInfoGet(p, &st);
+    MemClassInfo info[MEM_PART_CLASSES];
+    size_t extents = 0, caches = 0, largeBlocks;
+    pthread_mutex_lock(&p->lock);
+    mem_collect_locked(p, info);
+    for (MemExtent* e = p->extents; e; e = e->next) extents++;
+    for (MemCache* c = p->caches; c; c = c->next) caches++;
+    largeBlocks = p->largeBlocks;
+    pthread_mutex_unlock(&p->lock);
+
+    printf("Partition %p: pool %zu bytes, %zu usable\n", (void*)p, p->poolSize, (size_t)(p->end - p->base));
+    printf("  allocated  %10zu bytes in %zu blocks (%zu large)\n", st.numBytesAlloc, st.numBlocksAlloc, largeBlocks);
+    printf("  free       %10zu bytes in %zu blocks (%zu extents), largest %zu\n",
+           st.numBytesFree, st.numBlocksFree, extents, st.maxBlockSizeFree);
+    printf("  high water %10zu bytes, %zu thread caches, %llu failed allocations\n",
+           st.maxBytesAlloc, caches,
+           (unsigned long long)__atomic_load_n(&p->failures, __ATOMIC_RELAXED));
+    if (type < MEM_PART_SHOW_CLASSES) return OK;
+
+    printf("  %6s %8s %8s %8s %8s %12s\n", "SIZE", "CARVED", "IN USE", "FREE", "CACHED", "ALLOCS");
+    for (unsigned i = 0; i < MEM_PART_CLASSES; i++) {
+        if (!info[i].carved) continue;
+        printf("  %6u %8zu %8zu %8zu %8zu %12llu\n", g_classSize[i], info[i].carved, info[i].inUse,
+               info[i].free, info[i].cached, (unsigned long long)info[i].allocs);
+    }
+    return OK;
+}
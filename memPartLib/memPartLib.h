@@ -0,0 +1,117 @@
+/**
+ * @file memPartLib.h
+ * @brief VxWorks-like memory partitions: allocation from a fixed pool.
+ *
+ * A partition hands out memory from one pool given at creation, so a task
+ * that allocates from it never enters malloc and never competes for glibc
+ * arenas. Requests up to ::MEM_PART_SMALL_MAX bytes are rounded up to one
+ * of ::MEM_PART_CLASSES size classes. Each thread keeps a small cache of
+ * free blocks per class, so most ::memPartAlloc and ::memPartFree calls
+ * take no lock. Larger requests come from a first-fit list of free extents
+ * that are merged again when freed.
+ */
+
+#ifndef __INCmemPartLibh
+#define __INCmemPartLibh
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup memPartLib Memory Partition Library
+ *  @brief Emulation of VxWorks memory partitions.
+ *  @{
+ */
+
+#ifndef OK
+#define OK 0
+#endif
+#ifndef ERROR
+#define ERROR -1
+#endif
+
+#ifndef __PART_ID_DEFINED
+#define __PART_ID_DEFINED
+typedef void* PART_ID;      // also declared by msgQLib.h and mboxLib.h
+#endif
+
+/** Largest request served from a size class; larger ones are carved from the pool. */
+#define MEM_PART_SMALL_MAX      8192
+/** Number of size classes: 16-byte steps to 128, then four per power of two. */
+#define MEM_PART_CLASSES        32
+
+/** ::memPartShow levels */
+#define MEM_PART_SHOW_SUMMARY   0
+#define MEM_PART_SHOW_CLASSES   1
+
+/** Partition statistics returned by ::memPartInfoGet. Byte counts include
+    the 16-byte block header. */
+typedef struct {
+    size_t numBytesFree;        /**< pool bytes not in allocated blocks */
+    size_t numBlocksFree;       /**< free class blocks plus free extents */
+    size_t maxBlockSizeFree;    /**< largest request that can still be served */
+    size_t numBytesAlloc;       /**< bytes in allocated blocks */
+    size_t numBlocksAlloc;      /**< allocated blocks */
+    size_t maxBytesAlloc;       /**< high-water mark of pool bytes ever handed out */
+} MEM_PART_STATS;
+
+/**
+ * @brief Create a partition.
+ *
+ * The partition's control data lives at the start of the pool, so creating
+ * and using a partition never calls malloc.
+ *
+ * @param pPool Pool memory, or NULL to have one of @p poolSize bytes
+ *        mapped (and unmapped again by ::memPartDelete).
+ * @param poolSize Pool size in bytes.
+ * @return Partition ID, or NULL if the pool is too small or no more
+ *         thread-cache keys are available.
+ */
+PART_ID memPartCreate (char *pPool, size_t poolSize);
+
+/**
+ * @brief Delete a partition. Blocks still allocated become invalid.
+ *
+ * @return OK, or ERROR if @p partId is not a partition.
+ */
+int memPartDelete (PART_ID partId);
+
+/**
+ * @brief Allocate @p nBytes bytes, aligned to 16 bytes.
+ *
+ * @return The block, or NULL (errno ENOMEM) if the pool is exhausted.
+ */
+void *memPartAlloc (PART_ID partId, size_t nBytes);
+
+/**
+ * @brief Return a block to its partition. Any thread may free a block.
+ *
+ * @return OK; ERROR (errno EINVAL) if @p pBlock is not an allocated block
+ *         of @p partId, e.g. on a double free. NULL is accepted.
+ */
+int memPartFree (PART_ID partId, void *pBlock);
+
+/**
+ * @brief Get a snapshot of the partition's statistics.
+ *
+ * Counters kept by other threads are read without stopping them, so the
+ * snapshot is exact only while the partition is idle.
+ */
+int memPartInfoGet (PART_ID partId, MEM_PART_STATS *pStats);
+
+/**
+ * @brief Print the partition's statistics; ::MEM_PART_SHOW_CLASSES adds
+ *        one line per size class in use.
+ */
+int memPartShow (PART_ID partId, int type);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INCmemPartLibh */
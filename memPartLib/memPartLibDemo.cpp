@@ -0,0 +1,77 @@
+/**
+ * @file memPartLibDemo.cpp
+ * @brief Demo application for the memory partition library
+ * @details Creates a partition in a static pool, allocates blocks of mixed
+ * sizes, lets a second thread free what the first one allocated, shows the
+ * statistics, runs a message queue out of the same partition and detects a
+ * double free.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include "memPartLib.h"
+#include "msgQLib.h"
+
+#define NBLOCKS 200
+
+static char g_pool[1024 * 1024];
+static PART_ID g_part = NULL;
+static void* g_blocks[NBLOCKS];
+
+/**
+ * @brief Frees every block allocated by main, from another thread
+ */
+static void* freer(void* arg) {
+    (void)arg;
+    for (int i = 0; i < NBLOCKS; i += 2) memPartFree(g_part, g_blocks[i]);
+    return NULL;
+}
+
+int main() {
+    printf("Memory Partition Library Example\n");
+    printf("================================\n\n");
+
+    g_part = memPartCreate(g_pool, sizeof(g_pool));
+    if (!g_part) {
+        printf("memPartCreate failed\n");
+        return 1;
+    }
+
+    for (int i = 0; i < NBLOCKS; i++) {
+        size_t n = i % 50 == 0 ? 20000 : 24 + (size_t)(i % 10) * 40;
+        g_blocks[i] = memPartAlloc(g_part, n);
+        memset(g_blocks[i], i, n);
+    }
+    printf("--- After %d allocations ---\n", NBLOCKS);
+    memPartShow(g_part, MEM_PART_SHOW_CLASSES);
+
+    pthread_t t;
+    pthread_create(&t, NULL, freer, NULL);
+    pthread_join(t, NULL);
+    for (int i = 1; i < NBLOCKS; i += 2) memPartFree(g_part, g_blocks[i]);
+    printf("\n--- All blocks freed (half of them by another thread) ---\n");
+    memPartShow(g_part, MEM_PART_SHOW_SUMMARY);
+
+    printf("\n--- Message queue allocating from the partition ---\n");
+    MSG_Q_ID q = msgQCreatePart(16, 64, MSG_Q_FIFO, g_part);
+    char msg[64];
+    for (int i = 0; i < 10; i++) {
+        snprintf(msg, sizeof(msg), "message %d", i);
+        msgQSend(q, msg, strlen(msg) + 1, 0, 0);
+    }
+    MEM_PART_STATS st;
+    memPartInfoGet(g_part, &st);
+    printf("queue + 10 messages: %zu blocks, %zu bytes\n", st.numBlocksAlloc, st.numBytesAlloc);
+    msgQDelete(q);
+
+    printf("\n--- Double free ---\n");
+    void* p = memPartAlloc(g_part, 100);
+    memPartFree(g_part, p);
+    if (memPartFree(g_part, p) == ERROR && errno == EINVAL) printf("second memPartFree rejected\n");
+
+    memPartDelete(g_part);
+    printf("\nExample completed\n");
+    return 0;
+}
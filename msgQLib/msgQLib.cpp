@@ -1,6 +1,7 @@
 
 #include "msgQLib.h"
 #include "tickLib.h"
+#include "eventLibP.h"
 
 #include <pthread.h>
 #include <time.h>
@@ -8,10 +9,17 @@
 #include <stdlib.h>
 #include <string.h>
 
+/* Weak: memPartLib is linked only by programs using msgQCreatePart, and a
+   non-NULL part can only have come from it. */
+extern "C" {
+void* memPartAlloc(PART_ID partId, size_t nBytes) __attribute__((weak));
+int   memPartFree(PART_ID partId, void* pBlock) __attribute__((weak));
+}
+
 typedef struct MsgNode {
     int prio;
     size_t len;
-    unsigned char* data;
+    unsigned char* data;  // follows the node in the same allocation
     struct MsgNode* next;
 } MsgNode;
 
@@ -25,8 +33,20 @@ typedef struct MQ {
     size_t count;
     MsgNode* head;
     MsgNode* tail;    // used for FIFO fast append
+    size_t receivers; // tasks blocked in msgQReceive
+    EVENTS_RSRC ev;   // task registered by msgQEvStart
+    PART_ID part;     // memory partition for the queue and its messages, NULL = heap
 } MQ;
 
+static void* mq_alloc(PART_ID part, size_t n) {
+    return part ? memPartAlloc(part, n) : malloc(n);
+}
+
+static void mq_free(PART_ID part, void* p) {
+    if (part) memPartFree(part, p);
+    else free(p);
+}
+
 static int add_ms_to_timespec(struct timespec* ts, unsigned long long ms) {
     const long NS_PER_MS = 1000000L;
     if (!ts) return -1;
@@ -39,6 +59,115 @@ static int add_ms_to_timespec(struct timespec* ts, unsigned long long ms) {
     return 0;
 }
 
+// A task blocked in a timed wait while tickLib runs virtual time. Once the
+// virtual count reaches expiry, the tick hook locks the waiter's mutex,
+// marks the wait timed out unless its predicate already holds, and
+// broadcasts the condition variable, so the tickAdvance() call that reaches
+// the timeout decides it.
+typedef struct MqVirtWaiter {
+    pthread_cond_t* cv;
+    pthread_mutex_t* mtx;
+    int (*pred)(void*);
+    void* ctx;
+    uint64_t expiry;
+    int linked;     // on g_virtWaiters; cleared by the hook when it expires the wait
+    int timedOut;   // set by the hook under mtx
+    struct MqVirtWaiter* prev;
+    struct MqVirtWaiter* next;
+} MqVirtWaiter;
+
+static pthread_mutex_t g_virtLock = PTHREAD_MUTEX_INITIALIZER;
+static MqVirtWaiter* g_virtWaiters = NULL;   // under g_virtLock
+static int g_virtCount = 0;                 // waiters listed; read without the lock
+// Serializes tickHookAdd/Delete. Neither lock is taken with a queue mutex
+// held: the hook takes g_virtLock and then queue mutexes, and tickHookDelete
+// waits for running hooks.
+static pthread_mutex_t g_virtHookLock = PTHREAD_MUTEX_INITIALIZER;
+static int g_virtHookUsers = 0;
+
+static void mq_virt_unlink_locked(MqVirtWaiter* w) {
+    if (w->prev) w->prev->next = w->next;
+    else g_virtWaiters = w->next;
+    if (w->next) w->next->prev = w->prev;
+    w->linked = 0;
+    __atomic_sub_fetch(&g_virtCount, 1, __ATOMIC_SEQ_CST);
+}
+
+// Tick hook: times out the virtual-time waits whose expiry was reached
+static void mq_virt_tick_hook(uint64_t tick, void* arg) {
+    (void)arg;
+    if (!__atomic_load_n(&g_virtCount, __ATOMIC_SEQ_CST)) return;
+    pthread_mutex_lock(&g_virtLock);
+    MqVirtWaiter* w = g_virtWaiters;
+    while (w) {
+        MqVirtWaiter* next = w->next;   // w may return once its mutex is released
+        if (tick >= w->expiry) {
+            pthread_mutex_lock(w->mtx);
+            if (!w->pred(w->ctx)) w->timedOut = 1;
+            mq_virt_unlink_locked(w);
+            pthread_cond_broadcast(w->cv);
+            pthread_mutex_unlock(w->mtx);
+        }
+        w = next;
+    }
+    pthread_mutex_unlock(&g_virtLock);
+}
+
+static void mq_virt_link(MqVirtWaiter* w) {
+    pthread_mutex_lock(&g_virtHookLock);
+    if (g_virtHookUsers++ == 0) tickHookAdd(mq_virt_tick_hook, NULL);
+    pthread_mutex_unlock(&g_virtHookLock);
+
+    pthread_mutex_lock(&g_virtLock);
+    w->prev = NULL;
+    w->next = g_virtWaiters;
+    if (w->next) w->next->prev = w;
+    g_virtWaiters = w;
+    w->linked = 1;
+    __atomic_add_fetch(&g_virtCount, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&g_virtLock);
+}
+
+static void mq_virt_unlink(MqVirtWaiter* w) {
+    pthread_mutex_lock(&g_virtLock);
+    if (w->linked) mq_virt_unlink_locked(w);
+    pthread_mutex_unlock(&g_virtLock);
+
+    pthread_mutex_lock(&g_virtHookLock);
+    if (--g_virtHookUsers == 0) tickHookDelete(mq_virt_tick_hook, NULL);
+    pthread_mutex_unlock(&g_virtHookLock);
+}
+
+// Timed wait in virtual time (caller holds mtx). The waiter is listed for
+// the tick hook with mtx released, so a predicate that held when it woke is
+// checked again once it is unlisted.
+static int wait_pred_virtual(pthread_cond_t* cv, pthread_mutex_t* mtx,
+                             int timeoutTicks, int (*pred)(void*), void* ctx) {
+    MqVirtWaiter w;
+    w.cv = cv;
+    w.mtx = mtx;
+    w.pred = pred;
+    w.ctx = ctx;
+    w.expiry = tickGet() + (uint64_t)timeoutTicks;
+
+    int ready = pred(ctx);
+    while (!ready && tickGet() < w.expiry) {
+        w.timedOut = 0;
+        pthread_mutex_unlock(mtx);
+        mq_virt_link(&w);
+        pthread_mutex_lock(mtx);
+        while (!pred(ctx) && !w.timedOut && tickGet() < w.expiry) {
+            pthread_cond_wait(cv, mtx);
+        }
+        pthread_mutex_unlock(mtx);
+        mq_virt_unlink(&w);
+        pthread_mutex_lock(mtx);
+        if (w.timedOut) return 0;
+        ready = pred(ctx);
+    }
+    return ready;
+}
+
 static int wait_pred_with_timeout(pthread_cond_t* cv, pthread_mutex_t* mtx,
                                   int timeoutTicks, int (*pred)(void*), void* ctx) {
     if (timeoutTicks == 0) {
@@ -48,6 +177,8 @@ static int wait_pred_with_timeout(pthread_cond_t* cv, pthread_mutex_t* mtx,
             pthread_cond_wait(cv, mtx);
         }
         return 1;
+    } else if (tickVirtualModeGet()) {
+        return wait_pred_virtual(cv, mtx, timeoutTicks, pred, ctx);
     } else {
         int tps = sysClkRateGet(); if (tps <= 0) tps = 60;
         unsigned long long ms = ((unsigned long long)timeoutTicks * 1000ULL) / (unsigned long long)tps;
@@ -63,6 +194,16 @@ static int wait_pred_with_timeout(pthread_cond_t* cv, pthread_mutex_t* mtx,
     }
 }
 
+// Condition variables time out against CLOCK_MONOTONIC deadlines
+static int cond_init_monotonic(pthread_cond_t* cv) {
+    pthread_condattr_t attr;
+    if (pthread_condattr_init(&attr) != 0) return -1;
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    int rc = pthread_cond_init(cv, &attr);
+    pthread_condattr_destroy(&attr);
+    return rc;
+}
+
 static int pred_can_send(void* ctx) {
     MQ* q = (MQ*)ctx;
     return !q->valid ? 1 : (q->count < q->maxMsgs);
@@ -73,16 +214,18 @@ static int pred_has_data(void* ctx) {
     return !q->valid ? 1 : (q->count > 0);
 }
 
-MSG_Q_ID msgQCreate(size_t maxMsgs, size_t maxMsgLen, int options) {
+MSG_Q_ID msgQCreatePart(size_t maxMsgs, size_t maxMsgLen, int options, PART_ID part) {
     if (maxMsgs == 0 || maxMsgLen == 0) return NULL;
-    MQ* q = (MQ*)calloc(1, sizeof(MQ));
+    MQ* q = (MQ*)mq_alloc(part, sizeof(MQ));
     if (!q) return NULL;
-    if (pthread_mutex_init(&q->mtx, NULL) != 0) { free(q); return NULL; }
-    if (pthread_cond_init(&q->canSend, NULL) != 0) { pthread_mutex_destroy(&q->mtx); free(q); return NULL; }
-    if (pthread_cond_init(&q->canRecv, NULL) != 0) {
+    memset(q, 0, sizeof(MQ));
+    q->part = part;
+    if (pthread_mutex_init(&q->mtx, NULL) != 0) { mq_free(part, q); return NULL; }
+    if (cond_init_monotonic(&q->canSend) != 0) { pthread_mutex_destroy(&q->mtx); mq_free(part, q); return NULL; }
+    if (cond_init_monotonic(&q->canRecv) != 0) {
         pthread_cond_destroy(&q->canSend);
         pthread_mutex_destroy(&q->mtx);
-        free(q);
+        mq_free(part, q);
         return NULL;
     }
     q->maxMsgs = maxMsgs;
@@ -94,6 +237,10 @@ MSG_Q_ID msgQCreate(size_t maxMsgs, size_t maxMsgLen, int options) {
     return q;
 }
 
+MSG_Q_ID msgQCreate(size_t maxMsgs, size_t maxMsgLen, int options) {
+    return msgQCreatePart(maxMsgs, maxMsgLen, options, NULL);
+}
+
 int msgQDelete(MSG_Q_ID id) {
     if (!id) return -1;
     MQ* q = (MQ*)id;
@@ -109,15 +256,14 @@ int msgQDelete(MSG_Q_ID id) {
 
     while (n) {
         MsgNode* next = n->next;
-        free(n->data);
-        free(n);
+        mq_free(q->part, n);
         n = next;
     }
 
     pthread_cond_destroy(&q->canRecv);
     pthread_cond_destroy(&q->canSend);
     pthread_mutex_destroy(&q->mtx);
-    free(q);
+    mq_free(q->part, q);
     return 0;
 }
 
@@ -134,12 +280,11 @@ int msgQSend(MSG_Q_ID id, const void* buf, size_t nbytes, int timeoutTicks, int
     if (!q->valid) { pthread_mutex_unlock(&q->mtx); return -1; }
 
     size_t len = nbytes > q->maxLen ? q->maxLen : nbytes;
-    MsgNode* node = (MsgNode*)malloc(sizeof(MsgNode));
+    MsgNode* node = (MsgNode*)mq_alloc(q->part, sizeof(MsgNode) + len);
     if (!node) { pthread_mutex_unlock(&q->mtx); return -1; }
     node->prio = priority;
     node->len = len;
-    node->data = (unsigned char*)malloc(len ? len : 1);
-    if (!node->data) { free(node); pthread_mutex_unlock(&q->mtx); return -1; }
+    node->data = (unsigned char*)(node + 1);
     if (len && buf) memcpy(node->data, buf, len);
     node->next = NULL;
 
@@ -162,6 +307,8 @@ int msgQSend(MSG_Q_ID id, const void* buf, size_t nbytes, int timeoutTicks, int
     }
     q->count += 1;
     pthread_cond_signal(&q->canRecv);
+    // events only for messages that no blocked receiver is about to take
+    if (q->count > q->receivers) eventRsrcSend(&q->ev);
     pthread_mutex_unlock(&q->mtx);
     return 0;
 }
@@ -172,7 +319,10 @@ int msgQReceive(MSG_Q_ID id, void* buf, size_t maxNBytes, int timeoutTicks, size
     pthread_mutex_lock(&q->mtx);
     if (!q->valid) { pthread_mutex_unlock(&q->mtx); return -1; }
 
-    if (!wait_pred_with_timeout(&q->canRecv, &q->mtx, timeoutTicks, pred_has_data, q)) {
+    q->receivers += 1;
+    int ready = wait_pred_with_timeout(&q->canRecv, &q->mtx, timeoutTicks, pred_has_data, q);
+    q->receivers -= 1;
+    if (!ready) {
         pthread_mutex_unlock(&q->mtx);
         return -1;
     }
@@ -193,7 +343,26 @@ int msgQReceive(MSG_Q_ID id, void* buf, size_t maxNBytes, int timeoutTicks, size
     pthread_cond_signal(&q->canSend);
     pthread_mutex_unlock(&q->mtx);
 
-    free(node->data);
-    free(node);
+    mq_free(q->part, node);
     return 0;
 }
+
+int msgQEvStart(MSG_Q_ID id, uint32_t events, int options) {
+    if (!id) return -1;
+    MQ* q = (MQ*)id;
+    pthread_mutex_lock(&q->mtx);
+    if (!q->valid) { pthread_mutex_unlock(&q->mtx); return -1; }
+    int rc = eventRsrcStart(&q->ev, events, options);
+    if (rc == 0 && (options & EVENTS_SEND_IF_FREE) && q->count > 0) eventRsrcSend(&q->ev);
+    pthread_mutex_unlock(&q->mtx);
+    return rc;
+}
+
+int msgQEvStop(MSG_Q_ID id) {
+    if (!id) return -1;
+    MQ* q = (MQ*)id;
+    pthread_mutex_lock(&q->mtx);
+    int rc = q->valid ? eventRsrcStop(&q->ev) : -1;
+    pthread_mutex_unlock(&q->mtx);
+    return rc;
+}
@@ -14,16 +14,30 @@ extern "C" {
 
 typedef void* MSG_Q_ID;
 
+#ifndef __PART_ID_DEFINED
+#define __PART_ID_DEFINED
+typedef void* PART_ID;      /* memPartLib partition, see msgQCreatePart */
+#endif
+
 enum {
     MSG_Q_FIFO = 0,
     MSG_Q_PRIORITY = 1
 };
 
 MSG_Q_ID msgQCreate(size_t maxMsgs, size_t maxMsgLen, int options);
+/* Like msgQCreate, but the queue and every message are allocated from `part` (NULL = heap) */
+MSG_Q_ID msgQCreatePart(size_t maxMsgs, size_t maxMsgLen, int options, PART_ID part);
 int      msgQDelete(MSG_Q_ID id);
 int      msgQSend(MSG_Q_ID id, const void* buf, size_t nbytes, int timeoutTicks, int priority /*0=high..N*/);
 int      msgQReceive(MSG_Q_ID id, void* buf, size_t maxNBytes, int timeoutTicks, size_t* outLen /* may be null */);
 
+/* Event notification (eventLib.h): the registered task gets `events` whenever a
+   message arrives that no task blocked in msgQReceive will take. Options are
+   EVENTS_SEND_ONCE, EVENTS_ALLOW_OVERWRITE and EVENTS_SEND_IF_FREE (send at
+   once if messages are already queued). */
+int      msgQEvStart(MSG_Q_ID id, uint32_t events, int options);
+int      msgQEvStop(MSG_Q_ID id);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,149 @@
+
+#include "rngLib.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+
+/*
+ * head and tail run freely and are reduced with mask only to index the
+ * buffer, so head - tail is the fill level and all size bytes are usable.
+ * The producer writes the data, then publishes head with a release store;
+ * the consumer copies the data out, then publishes tail the same way.
+ * Each side keeps a private copy of the other side's index and reloads it
+ * only when the copy shows too little data (or space) for the whole
+ * request, so a put or get still moves every byte it can, and a side that
+ * stays ahead of the other does not touch the other's cache line.
+ *
+ * The capacity is at most INT_MAX / 2 + 1 bytes, so rounding up cannot
+ * overflow and every count fits the int results.
+ */
+
+#define RNG_CACHE_LINE 64
+
+typedef struct Ring {
+    // written by the producer
+    size_t head __attribute__((aligned(RNG_CACHE_LINE)));
+    size_t tailCache;           // producer's last view of tail
+
+    // written by the consumer
+    size_t tail __attribute__((aligned(RNG_CACHE_LINE)));
+    size_t headCache;           // consumer's last view of head
+
+    // read-only after create
+    char*  buf __attribute__((aligned(RNG_CACHE_LINE)));
+    size_t size;                // power of two
+    size_t mask;
+} Ring;
+
+static inline size_t rng_load(const size_t* p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline void rng_publish(size_t* p, size_t v) {
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+RING_ID rngCreate(size_t nbytes) {
+    if (nbytes == 0 || nbytes > (size_t)INT_MAX / 2 + 1) return NULL;
+    size_t size = 1;
+    while (size < nbytes) size <<= 1;
+
+    void* mem = NULL;
+    if (posix_memalign(&mem, RNG_CACHE_LINE, sizeof(Ring) + size) != 0) return NULL;
+    Ring* r = (Ring*)mem;
+    memset(r, 0, sizeof(Ring));
+    r->buf = (char*)(r + 1);    // sizeof(Ring) is a multiple of the cache line
+    r->size = size;
+    r->mask = size - 1;
+    return r;
+}
+
+void rngDelete(RING_ID ringId) {
+    free(ringId);
+}
+
+void rngFlush(RING_ID ringId) {
+    Ring* r = (Ring*)ringId;
+    if (!r) return;
+    size_t head = rng_load(&r->head);
+    r->headCache = head;
+    rng_publish(&r->tail, head);
+}
+
+int rngBufGet(RING_ID ringId, char* buffer, int maxbytes) {
+    Ring* r = (Ring*)ringId;
+    if (!r || !buffer || maxbytes <= 0) return 0;
+
+    size_t tail = r->tail;
+    size_t avail = r->headCache - tail;
+    if (avail < (size_t)maxbytes) {
+        r->headCache = rng_load(&r->head);
+        avail = r->headCache - tail;
+    }
+    size_t n = avail < (size_t)maxbytes ? avail : (size_t)maxbytes;
+    if (n == 0) return 0;
+
+    size_t off = tail & r->mask;
+    size_t first = r->size - off < n ? r->size - off : n;
+    memcpy(buffer, r->buf + off, first);
+    memcpy(buffer + first, r->buf, n - first);
+    rng_publish(&r->tail, tail + n);
+    return (int)n;
+}
+
+int rngBufPut(RING_ID ringId, const char* buffer, int nbytes) {
+    Ring* r = (Ring*)ringId;
+    if (!r || !buffer || nbytes <= 0) return 0;
+
+    size_t head = r->head;
+    size_t space = r->size - (head - r->tailCache);
+    if (space < (size_t)nbytes) {
+        r->tailCache = rng_load(&r->tail);
+        space = r->size - (head - r->tailCache);
+    }
+    size_t n = space < (size_t)nbytes ? space : (size_t)nbytes;
+    if (n == 0) return 0;
+
+    size_t off = head & r->mask;
+    size_t first = r->size - off < n ? r->size - off : n;
+    memcpy(r->buf + off, buffer, first);
+    memcpy(r->buf, buffer + first, n - first);
+    rng_publish(&r->head, head + n);
+    return (int)n;
+}
+
+int rngIsEmpty(RING_ID ringId) {
+    return rngNBytes(ringId) == 0;
+}
+
+int rngIsFull(RING_ID ringId) {
+    Ring* r = (Ring*)ringId;
+    return r && rngNBytes(ringId) == (int)r->size;
+}
+
+int rngFreeBytes(RING_ID ringId) {
+    Ring* r = (Ring*)ringId;
+    if (!r) return 0;
+    return (int)r->size - rngNBytes(ringId);
+}
+
+int rngNBytes(RING_ID ringId) {
+    Ring* r = (Ring*)ringId;
+    if (!r) return 0;
+    // tail first: head can only have grown since, so the result never underflows
+    size_t tail = rng_load(&r->tail);
+    size_t head = rng_load(&r->head);
+    return (int)(head - tail);
+}
+
+void rngPutAhead(RING_ID ringId, char byte, int offset) {
+    Ring* r = (Ring*)ringId;
+    r->buf[(r->head + (size_t)offset) & r->mask] = byte;
+}
+
+void rngMoveAhead(RING_ID ringId, int n) {
+    Ring* r = (Ring*)ringId;
+    rng_publish(&r->head, r->head + (size_t)n);
+}
@@ -0,0 +1,95 @@
+/**
+ * @file rngLib.h
+ * @brief VxWorks-like ring buffers: a lock-free byte FIFO for one writer
+ *        and one reader.
+ *
+ * One producer (a driver's interrupt handler, a signal handler or a task)
+ * and one consumer task may use a ring at the same time without a lock;
+ * every call finishes in a bounded number of steps. The producer side is
+ * ::rngBufPut, ::rngPutAhead and ::rngMoveAhead; the consumer side is
+ * ::rngBufGet and ::rngFlush. The query functions may be called from
+ * either side.
+ *
+ * The capacity is rounded up to a power of two, and the producer and
+ * consumer indices live on separate cache lines. Puts and gets copy with
+ * at most two memcpy calls, split at the wrap point.
+ */
+
+#ifndef __INCrngLibh
+#define __INCrngLibh
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup rngLib Ring Buffer Library
+ *  @brief Emulation of VxWorks ring buffers.
+ *  @{
+ */
+
+typedef void* RING_ID;
+
+/**
+ * @brief Create an empty ring holding at least @p nbytes bytes.
+ *
+ * @return Ring ID, or NULL if @p nbytes is 0 or more than INT_MAX / 2 + 1,
+ *         or memory is short.
+ */
+RING_ID rngCreate (size_t nbytes);
+
+/**
+ * @brief Delete a ring. Neither side may use it any more.
+ */
+void rngDelete (RING_ID ringId);
+
+/**
+ * @brief Discard the contents. Consumer side, or while the producer is idle.
+ */
+void rngFlush (RING_ID ringId);
+
+/**
+ * @brief Copy up to @p maxbytes bytes out of the ring. Consumer side.
+ *
+ * @return Bytes copied, 0 if the ring is empty.
+ */
+int rngBufGet (RING_ID ringId, char *buffer, int maxbytes);
+
+/**
+ * @brief Copy up to @p nbytes bytes into the ring. Producer side.
+ *
+ * @return Bytes copied; fewer than @p nbytes if the ring fills up.
+ */
+int rngBufPut (RING_ID ringId, const char *buffer, int nbytes);
+
+/** @brief 1 if the ring is empty, else 0. */
+int rngIsEmpty (RING_ID ringId);
+
+/** @brief 1 if the ring is full, else 0. */
+int rngIsFull (RING_ID ringId);
+
+/** @brief Bytes that can be put before the ring is full. */
+int rngFreeBytes (RING_ID ringId);
+
+/** @brief Bytes that can be got. */
+int rngNBytes (RING_ID ringId);
+
+/**
+ * @brief Store @p byte @p offset bytes past the end of the data without
+ *        making it visible. Producer side; the caller checks the space.
+ */
+void rngPutAhead (RING_ID ringId, char byte, int offset);
+
+/**
+ * @brief Make @p n bytes stored by ::rngPutAhead visible. Producer side.
+ */
+void rngMoveAhead (RING_ID ringId, int n);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INCrngLibh */
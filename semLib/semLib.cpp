@@ -6,8 +6,388 @@
  */
 
 #include "semLib.h"
+#include "tickLib.h"
+#include "eventLibP.h"
 #include <stdlib.h>
 #include <errno.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+/* Adaptive mutex tuning */
+#define SEM_SPIN_MIN_NS     200     /**< Spin budget floor while hold times are unknown */
+#define SEM_SPIN_MAX_NS     20000   /**< Upper bound; longer holds are never spun on */
+#define SEM_HOLD_EMA_SHIFT  3       /**< Hold-time average weight (1/8 per sample) */
+
+/**
+ * @brief Per-task run-state hint published to adaptive mutex waiters
+ *
+ * A task clears @c running before it blocks inside semLib and sets it again
+ * once it returns, so spinners can stop as soon as the owner leaves the CPU.
+ * Hints are recycled, never freed, so a stale owner pointer stays readable.
+ */
+typedef struct SemRunHint {
+    int running;
+    struct SemRunHint* next;
+} SemRunHint;
+
+static pthread_mutex_t g_hintLock = PTHREAD_MUTEX_INITIALIZER;
+static SemRunHint* g_hintFree = NULL;
+static pthread_key_t g_hintKey;
+static pthread_once_t g_hintOnce = PTHREAD_ONCE_INIT;
+static __thread SemRunHint* t_hint = NULL;
+static int g_spinAllowed = 0;
+
+static void semHintRelease(void* p) {
+    SemRunHint* h = (SemRunHint*)p;
+    __atomic_store_n(&h->running, 0, __ATOMIC_RELEASE);
+    pthread_mutex_lock(&g_hintLock);
+    h->next = g_hintFree;
+    g_hintFree = h;
+    pthread_mutex_unlock(&g_hintLock);
+}
+
+static void semHintInit(void) {
+    pthread_key_create(&g_hintKey, semHintRelease);
+    g_spinAllowed = sysconf(_SC_NPROCESSORS_ONLN) > 1;
+}
+
+/**
+ * @brief Returns the calling task's run-state hint, creating it on first use
+ */
+static SemRunHint* semHintSelf(void) {
+    if (t_hint) return t_hint;
+    pthread_once(&g_hintOnce, semHintInit);
+
+    pthread_mutex_lock(&g_hintLock);
+    SemRunHint* h = g_hintFree;
+    if (h) g_hintFree = h->next;
+    pthread_mutex_unlock(&g_hintLock);
+    if (!h && !(h = (SemRunHint*)calloc(1, sizeof(SemRunHint)))) return NULL;
+
+    h->next = NULL;
+    __atomic_store_n(&h->running, 1, __ATOMIC_RELEASE);
+    pthread_setspecific(g_hintKey, h);
+    t_hint = h;
+    return h;
+}
+
+/**
+ * @brief Marks the calling task as (not) running while it blocks in semLib
+ */
+static void semHintRunning(int running) {
+    if (t_hint) __atomic_store_n(&t_hint->running, running, __ATOMIC_RELEASE);
+}
+
+static unsigned long long semNowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+
+static inline void semCpuRelax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+static inline int semIsAdaptive(SEM_ID sem) {
+    return sem->type == SEM_TYPE_MUTEX && (sem->options & SEM_M_ADAPTIVE);
+}
+
+/**
+ * @brief Records ownership after an adaptive mutex has been acquired
+ */
+static void semAdaptiveAcquired(SEM_ID sem) {
+    sem->holdStart = (unsigned int)semNowNs();
+    __atomic_store_n(&sem->owner, (void*)semHintSelf(), __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Folds the finished hold into the average and drops ownership
+ *
+ * Called by the owner just before it unlocks the underlying mutex.
+ */
+static void semAdaptiveReleasing(SEM_ID sem) {
+    unsigned int held = (unsigned int)semNowNs() - sem->holdStart;
+    unsigned int avg = sem->holdNs;     // only the owner writes it
+    int delta = (int)(held > SEM_SPIN_MAX_NS * 2 ? SEM_SPIN_MAX_NS * 2 : held) - (int)avg;
+    __atomic_store_n(&sem->holdNs, (unsigned int)((int)avg + delta / (1 << SEM_HOLD_EMA_SHIFT)), __ATOMIC_RELAXED);
+    __atomic_store_n(&sem->owner, (void*)NULL, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Spins while the owner of an adaptive mutex is still on a CPU
+ *
+ * The budget is twice the recent average hold time, bounded by
+ * SEM_SPIN_MAX_NS. Mutexes whose holds exceed that bound are not spun on.
+ *
+ * @return 1 if the mutex was acquired while spinning, 0 if the caller must park
+ */
+static int semAdaptiveSpin(SEM_ID sem) {
+    unsigned int avg = __atomic_load_n(&sem->holdNs, __ATOMIC_RELAXED);
+    if (!g_spinAllowed || avg > SEM_SPIN_MAX_NS) return 0;
+
+    unsigned long long budget = SEM_SPIN_MIN_NS + 2ULL * avg;
+    if (budget > SEM_SPIN_MAX_NS) budget = SEM_SPIN_MAX_NS;
+    unsigned long long start = semNowNs();
+
+    for (unsigned int i = 1; ; i++) {
+        SemRunHint* owner = (SemRunHint*)__atomic_load_n(&sem->owner, __ATOMIC_ACQUIRE);
+        if (owner == NULL) {
+            if (pthread_mutex_trylock(&sem->mutex) == 0) return 1;
+        } else if (!__atomic_load_n(&owner->running, __ATOMIC_ACQUIRE)) {
+            return 0; // owner is blocked, spinning cannot help
+        }
+        semCpuRelax();
+        if ((i & 15) == 0 && semNowNs() - start > budget) return 0;
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+/* Extension blocks: event registration and statistics (-DSEM_STATS)      */
+/* ---------------------------------------------------------------------- */
+
+#define SEM_EXT_CHUNK   1024        /**< Extension blocks per table chunk */
+#define SEM_EXT_CHUNKS  1024        /**< Maximum number of table chunks */
+
+/**
+ * @brief Per-semaphore extension block, addressed by SEM_ID_STRUCT::extIdx
+ *
+ * Blocks live in a chunked table that never moves, so a take/give can reach
+ * its block with two loads and no lock. With -DSEM_STATS every semaphore
+ * gets a block when it is initialized; otherwise only semEvStart() attaches
+ * one. Counters are updated atomically; the top-waiter table is only
+ * touched on the contended path.
+ */
+typedef struct SemExt {
+    SEM_ID sem;                         /**< Owning semaphore, NULL while free */
+    unsigned int nextFree;              /**< Free-list link (index) */
+    EVENTS_RSRC events;                 /**< Task registered by semEvStart() */
+#ifdef SEM_STATS
+    unsigned long long holdStart;       /**< Acquisition time of the current holder (ns) */
+    SEM_STATS_INFO stats;
+    pthread_mutex_t waiterLock;         /**< Protects stats.topWaiters */
+#endif
+} SemExt;
+
+static pthread_mutex_t g_extLock = PTHREAD_MUTEX_INITIALIZER;
+static SemExt* g_extChunks[SEM_EXT_CHUNKS];
+static unsigned int g_extNext = 1;      /**< Next never-used index (0 is reserved) */
+static unsigned int g_extFree = 0;      /**< Head of the free-index list */
+
+static inline SemExt* semExtGet(unsigned int idx) {
+    return &g_extChunks[idx / SEM_EXT_CHUNK][idx % SEM_EXT_CHUNK];
+}
+
+/**
+ * @brief Gives a semaphore an extension block unless it already has one
+ *
+ * Called with g_extLock held. The index is published last, so a lock-free
+ * reader that sees it also sees the chunk and the cleared block.
+ *
+ * @return unsigned int The block index, 0 if the table is exhausted
+ */
+static unsigned int semExtAttachLocked(SEM_ID sem) {
+    if (sem->extIdx) return sem->extIdx;
+    unsigned int idx = g_extFree;
+    if (idx) {
+        g_extFree = semExtGet(idx)->nextFree;
+    } else if (g_extNext < SEM_EXT_CHUNK * SEM_EXT_CHUNKS) {
+        idx = g_extNext;
+        SemExt** chunk = &g_extChunks[idx / SEM_EXT_CHUNK];
+        if (!*chunk) {
+            *chunk = (SemExt*)calloc(SEM_EXT_CHUNK, sizeof(SemExt));
+#ifdef SEM_STATS
+            if (*chunk) {
+                for (int i = 0; i < SEM_EXT_CHUNK; i++) {
+                    pthread_mutex_init(&(*chunk)[i].waiterLock, NULL);
+                }
+            }
+#endif
+        }
+        if (*chunk) g_extNext++;
+        else idx = 0;
+    }
+    if (idx) {
+        SemExt* ext = semExtGet(idx);
+        memset(&ext->events, 0, sizeof(ext->events));
+#ifdef SEM_STATS
+        memset(&ext->stats, 0, sizeof(ext->stats));
+#endif
+        ext->sem = sem;
+        __atomic_store_n(&sem->extIdx, idx, __ATOMIC_RELEASE);
+    }
+    return idx;
+}
+
+/**
+ * @brief Returns a deleted semaphore's block to the free list
+ */
+static void semExtDetach(SEM_ID sem) {
+    if (!sem->extIdx) return;
+    pthread_mutex_lock(&g_extLock);
+    SemExt* ext = semExtGet(sem->extIdx);
+    ext->sem = NULL;
+    ext->nextFree = g_extFree;
+    g_extFree = sem->extIdx;
+    pthread_mutex_unlock(&g_extLock);
+    sem->extIdx = 0;
+}
+
+#ifdef SEM_STATS
+/* ---------------------------------------------------------------------- */
+/* Contention statistics (-DSEM_STATS)                                    */
+/* ---------------------------------------------------------------------- */
+
+static int g_semStatsOn = 0;
+
+/**
+ * @brief Registers a new semaphore in the statistics table
+ */
+static void semStatsAttach(SEM_ID sem) {
+    pthread_mutex_lock(&g_extLock);
+    semExtAttachLocked(sem);
+    pthread_mutex_unlock(&g_extLock);
+}
+
+static inline void semStatsAdd(unsigned long long* counter, unsigned long long v) {
+    __atomic_fetch_add(counter, v, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Accounts a contended acquisition of @p waitNs by the calling task
+ */
+static void semStatsWaited(SemExt* ext, unsigned long long waitNs) {
+    SEM_STATS_INFO* st = &ext->stats;
+    semStatsAdd(&st->contended, 1);
+    semStatsAdd(&st->waitNsTotal, waitNs);
+    unsigned long long max = __atomic_load_n(&st->waitNsMax, __ATOMIC_RELAXED);
+    while (waitNs > max &&
+           !__atomic_compare_exchange_n(&st->waitNsMax, &max, waitNs, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+
+    /* Space-saving top-k: accumulate, or evict the lightest entry */
+    int tid = (int)syscall(SYS_gettid);
+    pthread_mutex_lock(&ext->waiterLock);
+    int slot = SEM_TOP_WAITERS - 1;
+    for (int i = 0; i < SEM_TOP_WAITERS; i++) {
+        if (st->topWaiters[i].tid == tid || st->topWaiters[i].tid == 0) { slot = i; break; }
+    }
+    if (st->topWaiters[slot].tid != tid) {
+        st->topWaiters[slot].tid = tid;
+    }
+    st->topWaiters[slot].waitNs += waitNs;
+    while (slot > 0 && st->topWaiters[slot].waitNs > st->topWaiters[slot - 1].waitNs) {
+        int t = st->topWaiters[slot - 1].tid;
+        unsigned long long w = st->topWaiters[slot - 1].waitNs;
+        st->topWaiters[slot - 1] = st->topWaiters[slot];
+        st->topWaiters[slot].tid = t;
+        st->topWaiters[slot].waitNs = w;
+        slot--;
+    }
+    pthread_mutex_unlock(&ext->waiterLock);
+}
+
+/**
+ * @brief Accounts the hold that ends now in the log2 histogram
+ */
+static void semStatsReleased(SemExt* ext) {
+    unsigned long long held = semNowNs() - ext->holdStart;
+    int bucket = held ? 63 - __builtin_clzll(held) - 6 : 0;
+    if (bucket < 0) bucket = 0;
+    if (bucket >= SEM_HOLD_BUCKETS) bucket = SEM_HOLD_BUCKETS - 1;
+    semStatsAdd(&ext->stats.holdHist[bucket], 1);
+}
+#endif /* SEM_STATS */
+
+static_assert(sizeof(SEM_ID_STRUCT_ALIGNED) % SEM_CACHE_LINE == 0,
+              "SEM_ID_STRUCT_ALIGNED must occupy whole cache lines");
+
+/**
+ * @brief Allocates cache-line aligned storage for a heap semaphore
+ */
+static SEM_ID semAlloc(void) {
+    void* p = NULL;
+    if (posix_memalign(&p, SEM_CACHE_LINE, sizeof(SEM_ID_STRUCT_ALIGNED)) != 0) return NULL;
+    return (SEM_ID)p;
+}
+
+/**
+ * @brief Common part of the semXInit() routines
+ */
+static void semInitCommon(SEM_ID s, int type, int options) {
+    memset(s, 0, sizeof(SEM_ID_STRUCT));
+    s->type = (unsigned char)type;
+    s->flags = SEM_F_STATIC;
+    s->options = (unsigned short)options;
+}
+
+/**
+ * @brief Initializes a binary semaphore in caller-provided storage
+ * 
+ * @param pSem Storage for the semaphore, e.g. embedded in a caller structure
+ * @param options Creation options (SEM_Q_FIFO or SEM_Q_PRIORITY)
+ * @param initialState Initial state of the semaphore (0 = unavailable, 1 = available)
+ * @return int OK on success, ERROR on failure
+ */
+int semBInit(SEM_ID_STRUCT* pSem, int options, int initialState) {
+    if (!pSem) return ERROR;
+
+    semInitCommon(pSem, SEM_TYPE_BINARY, options);
+    if (sem_init(&pSem->posixSem, 0, initialState ? 1 : 0) != 0) return ERROR;
+#ifdef SEM_STATS
+    semStatsAttach(pSem);
+#endif
+    return OK;
+}
+
+/**
+ * @brief Initializes a counting semaphore in caller-provided storage
+ * 
+ * @param pSem Storage for the semaphore, e.g. embedded in a caller structure
+ * @param options Creation options (SEM_Q_FIFO or SEM_Q_PRIORITY)
+ * @param initialCount Initial value of the semaphore counter
+ * @return int OK on success, ERROR on failure
+ */
+int semCInit(SEM_ID_STRUCT* pSem, int options, int initialCount) {
+    if (!pSem || initialCount < 0) return ERROR;
+
+    semInitCommon(pSem, SEM_TYPE_COUNTING, options);
+    if (sem_init(&pSem->posixSem, 0, (unsigned int)initialCount) != 0) return ERROR;
+#ifdef SEM_STATS
+    semStatsAttach(pSem);
+#endif
+    return OK;
+}
+
+/**
+ * @brief Initializes a mutex semaphore in caller-provided storage
+ * 
+ * @param pSem Storage for the semaphore, e.g. embedded in a caller structure
+ * @param options Creation options (SEM_Q_FIFO or SEM_Q_PRIORITY, SEM_M_ADAPTIVE)
+ * @return int OK on success, ERROR on failure
+ */
+int semMInit(SEM_ID_STRUCT* pSem, int options) {
+    if (!pSem) return ERROR;
+
+    semInitCommon(pSem, SEM_TYPE_MUTEX, options);
+    if (pthread_mutex_init(&pSem->mutex, NULL) != 0) return ERROR;
+    if (options & SEM_M_ADAPTIVE) pthread_once(&g_hintOnce, semHintInit);
+#ifdef SEM_STATS
+    semStatsAttach(pSem);
+#endif
+    return OK;
+}
 
 /**
  * @brief Creates a binary semaphore
@@ -19,11 +399,11 @@
  * @note Binary semaphores have only two states: available (1) or unavailable (0)
  */
 SEM_ID semBCreate(int options, int initialState) {
-    SEM_ID s = (SEM_ID)malloc(sizeof(SEM_ID_STRUCT));
+    SEM_ID s = semAlloc();
     if (!s) return NULL;
 
-    s->type = SEM_TYPE_BINARY;
-    sem_init(&s->posixSem, 0, initialState ? 1 : 0);
+    if (semBInit(s, options, initialState) != OK) { free(s); return NULL; }
+    s->flags &= ~SEM_F_STATIC;
     return s;
 }
 
@@ -37,11 +417,11 @@ SEM_ID semBCreate(int options, int initialState) {
  * @note Counting semaphores can have any non-negative integer value
  */
 SEM_ID semCCreate(int options, int initialCount) {
-    SEM_ID s = (SEM_ID)malloc(sizeof(SEM_ID_STRUCT));
+    SEM_ID s = semAlloc();
     if (!s) return NULL;
 
-    s->type = SEM_TYPE_COUNTING;
-    sem_init(&s->posixSem, 0, initialCount);
+    if (semCInit(s, options, initialCount) != OK) { free(s); return NULL; }
+    s->flags &= ~SEM_F_STATIC;
     return s;
 }
 
@@ -51,17 +431,225 @@ SEM_ID semCCreate(int options, int initialCount) {
  * @param options Creation options (SEM_Q_FIFO or SEM_Q_PRIORITY)
  * @return SEM_ID Pointer to the created mutex, or NULL on failure
  * 
- * @note Mutex semaphores are used for mutual exclusion between threads
+ * @note Mutex semaphores are used for mutual exclusion between threads.
+ *       With SEM_M_ADAPTIVE a contended take spins briefly before parking.
  */
 SEM_ID semMCreate(int options) {
-    SEM_ID s = (SEM_ID)malloc(sizeof(SEM_ID_STRUCT));
+    SEM_ID s = semAlloc();
     if (!s) return NULL;
 
-    s->type = SEM_TYPE_MUTEX;
-    pthread_mutex_init(&s->mutex, NULL);
+    if (semMInit(s, options) != OK) { free(s); return NULL; }
+    s->flags &= ~SEM_F_STATIC;
     return s;
 }
 
+/**
+ * @brief Converts a tick timeout into an absolute CLOCK_MONOTONIC deadline
+ *
+ * A tick lasts 1/sysClkRateGet() seconds, as for taskDelay() and
+ * eventReceive(), and wall-clock steps do not move the deadline.
+ */
+static int semDeadline(int ticks, struct timespec* ts) {
+    if (clock_gettime(CLOCK_MONOTONIC, ts) == -1) return ERROR;
+
+    int rate = sysClkRateGet();
+    if (rate <= 0) rate = 60;
+    unsigned long long ns = (unsigned long long)ticks * 1000000000ULL / (unsigned long long)rate;
+    ts->tv_sec += (time_t)(ns / 1000000000ULL);
+    ts->tv_nsec += (long)(ns % 1000000000ULL);
+
+    // Normalize nanoseconds to seconds if overflow
+    if (ts->tv_nsec >= 1000000000) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000;
+    }
+    return OK;
+}
+
+/**
+ * @brief Maps a pthread mutex lock result onto OK/ERROR
+ *
+ * A robust (semOpen) mutex whose previous owner died while holding it is
+ * marked consistent and handed to the caller: the take succeeds with errno
+ * set to EOWNERDEAD so the caller can repair the protected state.
+ */
+static int semMutexResult(SEM_ID sem, int rc) {
+    if (rc == EOWNERDEAD) {
+        pthread_mutex_consistent(&sem->mutex);
+        errno = EOWNERDEAD;
+        return OK;
+    }
+    return rc == 0 ? OK : ERROR;
+}
+
+/**
+ * @brief Acquires an adaptive mutex: trylock, bounded spin, then park
+ */
+static int semTakeAdaptive(SEM_ID sem, int ticks) {
+    if (pthread_mutex_trylock(&sem->mutex) == 0) return OK;
+    if (ticks == 0) return ERROR;
+    if (semAdaptiveSpin(sem)) return OK;
+
+    struct timespec ts;
+    if (ticks > 0 && semDeadline(ticks, &ts) == ERROR) return ERROR;
+
+    semHintRunning(0);
+    int rc = ticks < 0 ? pthread_mutex_lock(&sem->mutex)
+                       : pthread_mutex_clocklock(&sem->mutex, CLOCK_MONOTONIC, &ts);
+    semHintRunning(1);
+    return rc == 0 ? OK : ERROR;
+}
+
+/**
+ * @brief A task blocked in a timed take while tickLib runs virtual time
+ *
+ * The task sleeps on @c seq. semGive() bumps it for the waiters of its
+ * semaphore, and the tick hook bumps it once the virtual tick count reaches
+ * @c expiry, so a waiter is woken by the tickAdvance() call that expires it.
+ */
+typedef struct SemVirtWaiter {
+    SEM_ID sem;
+    uint64_t expiry;
+    uint32_t seq;
+    struct SemVirtWaiter* prev;
+    struct SemVirtWaiter* next;
+} SemVirtWaiter;
+
+static pthread_mutex_t g_virtLock = PTHREAD_MUTEX_INITIALIZER;
+static SemVirtWaiter* g_virtWaiters = NULL;    /**< Under g_virtLock */
+static int g_virtCount = 0;                     /**< Waiters listed; read without the lock */
+/* Serializes tickHookAdd/Delete. Never taken with g_virtLock held: the hook
+   takes g_virtLock and tickHookDelete waits for running hooks. */
+static pthread_mutex_t g_virtHookLock = PTHREAD_MUTEX_INITIALIZER;
+static int g_virtHookUsers = 0;
+
+static void semVirtKick(SemVirtWaiter* w) {
+    __atomic_add_fetch(&w->seq, 1, __ATOMIC_RELEASE);
+    syscall(SYS_futex, &w->seq, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+/**
+ * @brief Tick hook: wakes the virtual-time waiters whose timeout expired
+ */
+static void semVirtTickHook(uint64_t tick, void* arg) {
+    (void)arg;
+    if (!__atomic_load_n(&g_virtCount, __ATOMIC_SEQ_CST)) return;
+    pthread_mutex_lock(&g_virtLock);
+    for (SemVirtWaiter* w = g_virtWaiters; w; w = w->next) {
+        if (tick >= w->expiry) semVirtKick(w);
+    }
+    pthread_mutex_unlock(&g_virtLock);
+}
+
+/**
+ * @brief Wakes the virtual-time waiters of a semaphore that was just given
+ */
+static void semVirtGiven(SEM_ID sem) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (!__atomic_load_n(&g_virtCount, __ATOMIC_SEQ_CST)) return;
+    pthread_mutex_lock(&g_virtLock);
+    for (SemVirtWaiter* w = g_virtWaiters; w; w = w->next) {
+        if (w->sem == sem) semVirtKick(w);
+    }
+    pthread_mutex_unlock(&g_virtLock);
+}
+
+/**
+ * @brief Timed take in tickLib virtual time
+ *
+ * Sleeps until semGive() or the tickAdvance() that reaches the timeout
+ * wakes it. The tick hook is registered only while such waiters exist. A
+ * shared semaphore can be given by another process, which cannot wake the
+ * waiter, so it also re-checks every TICK_VIRTUAL_POLL_MS.
+ */
+static int semTakeVirtual(SEM_ID sem, int ticks) {
+    SemVirtWaiter w;
+    w.sem = sem;
+    w.expiry = tickGet() + (uint64_t)ticks;
+    w.seq = 0;
+    w.prev = NULL;
+
+    pthread_mutex_lock(&g_virtHookLock);
+    if (g_virtHookUsers++ == 0) tickHookAdd(semVirtTickHook, NULL);
+    pthread_mutex_unlock(&g_virtHookLock);
+
+    pthread_mutex_lock(&g_virtLock);
+    w.next = g_virtWaiters;
+    if (w.next) w.next->prev = &w;
+    g_virtWaiters = &w;
+    __atomic_add_fetch(&g_virtCount, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&g_virtLock);
+
+    struct timespec slice = {0, TICK_VIRTUAL_POLL_MS * 1000000L};
+    int rc;
+    semHintRunning(0);
+    for (;;) {
+        uint32_t seq = __atomic_load_n(&w.seq, __ATOMIC_ACQUIRE);
+        if (sem->type == SEM_TYPE_MUTEX) {
+            rc = semMutexResult(sem, pthread_mutex_trylock(&sem->mutex));
+        } else {
+            rc = sem_trywait(&sem->posixSem) == 0 ? OK : ERROR;
+        }
+        if (rc == OK || tickGet() >= w.expiry) break;
+        syscall(SYS_futex, &w.seq, FUTEX_WAIT_PRIVATE, seq,
+                (sem->flags & SEM_F_SHARED) ? &slice : NULL, NULL, 0);
+    }
+    semHintRunning(1);
+
+    pthread_mutex_lock(&g_virtLock);
+    if (w.prev) w.prev->next = w.next;
+    else g_virtWaiters = w.next;
+    if (w.next) w.next->prev = w.prev;
+    __atomic_sub_fetch(&g_virtCount, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&g_virtLock);
+
+    pthread_mutex_lock(&g_virtHookLock);
+    if (--g_virtHookUsers == 0) tickHookDelete(semVirtTickHook, NULL);
+    pthread_mutex_unlock(&g_virtHookLock);
+    return rc;
+}
+
+/**
+ * @brief Acquires a semaphore without any statistics bookkeeping
+ */
+static int semTakeImpl(SEM_ID sem, int ticks) {
+    if (ticks > 0 && tickVirtualModeGet()) {
+        int rc = semTakeVirtual(sem, ticks);
+        if (rc == OK && semIsAdaptive(sem)) semAdaptiveAcquired(sem);
+        return rc;
+    }
+
+    if (semIsAdaptive(sem)) {
+        int rc = semTakeAdaptive(sem, ticks);
+        if (rc == OK) semAdaptiveAcquired(sem);
+        return rc;
+    }
+
+    struct timespec ts;
+    int rc;
+    if (ticks > 0 && semDeadline(ticks, &ts) == ERROR) return ERROR;
+
+    if (sem->type == SEM_TYPE_MUTEX) {
+        if (ticks == 0) {
+            return semMutexResult(sem, pthread_mutex_trylock(&sem->mutex));
+        }
+        semHintRunning(0);
+        rc = ticks < 0 ? pthread_mutex_lock(&sem->mutex)
+                         : pthread_mutex_clocklock(&sem->mutex, CLOCK_MONOTONIC, &ts);
+        semHintRunning(1);
+        return semMutexResult(sem, rc);
+    } else {
+        if (ticks == 0) {
+            return sem_trywait(&sem->posixSem) == 0 ? OK : ERROR;
+        }
+        semHintRunning(0);
+        rc = ticks < 0 ? sem_wait(&sem->posixSem)
+                         : sem_clockwait(&sem->posixSem, CLOCK_MONOTONIC, &ts);
+    }
+    semHintRunning(1);
+    return rc == 0 ? OK : ERROR;
+}
+
 /**
  * @brief Attempts to acquire a semaphore
  * 
@@ -69,7 +657,9 @@ SEM_ID semMCreate(int options) {
  * @param ticks Timeout specification:
  *              - -1: wait forever (block indefinitely)
  *              - 0: non-blocking, return immediately
- *              - >0: wait for specified number of ticks (approx 10ms per tick)
+ *              - >0: wait for specified number of ticks of tickLib's clock
+ *                (sysClkRateGet() per second, or virtual ticks in virtual
+ *                time mode)
  * @return int OK on success, ERROR on failure or timeout
  * 
  * @note For mutex semaphores, this function provides recursive acquisition protection
@@ -77,51 +667,23 @@ SEM_ID semMCreate(int options) {
 int semTake(SEM_ID sem, int ticks) {
     if (!sem) return ERROR;
 
-    if (sem->type == SEM_TYPE_MUTEX) {
-        if (ticks == -1) {
-            return pthread_mutex_lock(&sem->mutex) == 0 ? OK : ERROR;
-        } else if (ticks == 0) {
-            return pthread_mutex_trylock(&sem->mutex) == 0 ? OK : ERROR;
-        } else {
-            // Convert ticks to absolute time for timed wait
-            struct timespec ts;
-            if (clock_gettime(CLOCK_REALTIME, &ts) == -1) return ERROR;
-            
-            // Assuming 100 ticks per second (10ms per tick)
-            ts.tv_sec += ticks / 100;
-            ts.tv_nsec += (ticks % 100) * 10000000; // 10ms in nanoseconds
-            
-            // Normalize nanoseconds to seconds if overflow
-            if (ts.tv_nsec >= 1000000000) {
-                ts.tv_sec++;
-                ts.tv_nsec -= 1000000000;
-            }
-            
-            return pthread_mutex_timedlock(&sem->mutex, &ts) == 0 ? OK : ERROR;
+#ifdef SEM_STATS
+    if (sem->extIdx && __atomic_load_n(&g_semStatsOn, __ATOMIC_RELAXED)) {
+        SemExt* ext = semExtGet(sem->extIdx);
+        int rc = semTakeImpl(sem, 0);
+        if (rc != OK && ticks != 0) {
+            unsigned long long t0 = semNowNs();
+            rc = semTakeImpl(sem, ticks);
+            if (rc == OK) semStatsWaited(ext, semNowNs() - t0);
         }
-    } else {
-        if (ticks == -1) {
-            return sem_wait(&sem->posixSem) == 0 ? OK : ERROR;
-        } else if (ticks == 0) {
-            return sem_trywait(&sem->posixSem) == 0 ? OK : ERROR;
-        } else {
-            // Convert ticks to absolute time for timed wait
-            struct timespec ts;
-            if (clock_gettime(CLOCK_REALTIME, &ts) == -1) return ERROR;
-            
-            // Assuming 100 ticks per second (10ms per tick)
-            ts.tv_sec += ticks / 100;
-            ts.tv_nsec += (ticks % 100) * 10000000; // 10ms in nanoseconds
-            
-            // Normalize nanoseconds to seconds if overflow
-            if (ts.tv_nsec >= 1000000000) {
-                ts.tv_sec++;
-                ts.tv_nsec -= 1000000000;
-            }
-            
-            return sem_timedwait(&sem->posixSem, &ts) == 0 ? OK : ERROR;
+        if (rc == OK) {
+            semStatsAdd(&ext->stats.acquisitions, 1);
+            if (sem->type == SEM_TYPE_MUTEX) ext->holdStart = semNowNs();
         }
+        return rc;
     }
+#endif
+    return semTakeImpl(sem, ticks);
 }
 
 /**
@@ -137,10 +699,93 @@ int semGive(SEM_ID sem) {
     if (!sem) return ERROR;
 
     if (sem->type == SEM_TYPE_MUTEX) {
-        return pthread_mutex_unlock(&sem->mutex) == 0 ? OK : ERROR;
+#ifdef SEM_STATS
+        if (sem->extIdx && __atomic_load_n(&g_semStatsOn, __ATOMIC_RELAXED)) {
+            semStatsReleased(semExtGet(sem->extIdx));
+        }
+#endif
+        if (semIsAdaptive(sem)) semAdaptiveReleasing(sem);
+        if (pthread_mutex_unlock(&sem->mutex) != 0) return ERROR;
     } else {
-        return sem_post(&sem->posixSem) == 0 ? OK : ERROR;
+        if (sem_post(&sem->posixSem) != 0) return ERROR;
+    }
+
+    if (tickVirtualModeGet()) semVirtGiven(sem);
+    unsigned int idx = __atomic_load_n(&sem->extIdx, __ATOMIC_ACQUIRE);
+    if (idx) eventRsrcSend(&semExtGet(idx)->events);
+    return OK;
+}
+
+/**
+ * @brief Reports whether a take would probably succeed, without taking
+ */
+static int semLooksAvailable(SEM_ID sem) {
+    if (sem->type == SEM_TYPE_MUTEX) {
+        return !semIsAdaptive(sem) || __atomic_load_n(&sem->owner, __ATOMIC_ACQUIRE) == NULL;
+    }
+    int value = 0;
+    sem_getvalue(&sem->posixSem, &value);
+    return value > 0;
+}
+
+/**
+ * @brief Gives one semaphore and takes another as a single operation
+ * 
+ * Both ids are validated before anything is given. After the give, the
+ * caller does not park straight away:
+ * - on a single CPU it yields once, so the task just woken by the give runs
+ *   immediately and can answer before the caller ever sleeps;
+ * - on SMP it polls @p take for twice the recent reply latency (bounded by
+ *   SEM_SPIN_MAX_NS), because the peer is typically already running.
+ * Only if no reply arrived does it block like semTake(). A synchronous
+ * request/response round trip thus costs about one context switch instead
+ * of a separate wakeup and sleep per side.
+ * 
+ * @param give Semaphore to release
+ * @param take Semaphore to acquire afterwards
+ * @param ticks Timeout for the take, as for semTake()
+ * @return int OK if @p give was released and @p take acquired, ERROR otherwise
+ *
+ * @note If the give succeeds but the take times out, @p give stays released.
+ */
+int semExchange(SEM_ID give, SEM_ID take, int ticks) {
+    if (!give || !take || give == take) return ERROR;
+    if (semGive(give) != OK) return ERROR;
+    int rc = semTake(take, 0);
+    if (rc == OK || ticks == 0) return rc;
+
+    pthread_once(&g_hintOnce, semHintInit);
+    unsigned long long start = semNowNs();
+    unsigned int avg;
+
+    if (!g_spinAllowed) {
+        sched_yield();
+        rc = semTake(take, 0);
+    } else if (take->type != SEM_TYPE_MUTEX &&
+               (avg = __atomic_load_n(&take->holdNs, __ATOMIC_RELAXED)) <= SEM_SPIN_MAX_NS) {
+        unsigned long long budget = SEM_SPIN_MIN_NS + 2ULL * avg;
+        if (budget > SEM_SPIN_MAX_NS) budget = SEM_SPIN_MAX_NS;
+        for (unsigned int i = 1; ; i++) {
+            if (semLooksAvailable(take) && (rc = semTake(take, 0)) == OK) break;
+            semCpuRelax();
+            if ((i & 15) == 0 && semNowNs() - start > budget) break;
+        }
+    }
+    if (rc != OK) rc = semTake(take, ticks);
+
+    if (rc == OK && take->type != SEM_TYPE_MUTEX) {
+        /* Binary/counting semaphores reuse holdNs as the average reply latency.
+           Every task exchanging on @take updates it, hence the CAS. */
+        unsigned long long waited = semNowNs() - start;
+        int sample = (int)(waited > SEM_SPIN_MAX_NS * 2 ? SEM_SPIN_MAX_NS * 2 : waited);
+        avg = __atomic_load_n(&take->holdNs, __ATOMIC_RELAXED);
+        unsigned int next;
+        do {
+            next = (unsigned int)((int)avg + (sample - (int)avg) / (1 << SEM_HOLD_EMA_SHIFT));
+        } while (!__atomic_compare_exchange_n(&take->holdNs, &avg, next, 1,
+                                              __ATOMIC_RELAXED, __ATOMIC_RELAXED));
     }
+    return rc;
 }
 
 /**
@@ -151,17 +796,395 @@ int semGive(SEM_ID sem) {
  * 
  * @warning It is the caller's responsibility to ensure no threads are waiting on
  *          the semaphore when it is deleted.
+ * @note Semaphores set up with semBInit/semCInit/semMInit are destroyed but
+ *       their storage is left to the caller. Named semaphores from semOpen()
+ *       are only closed; see semUnlink().
  */
 int semDelete(SEM_ID sem) {
     if (!sem) return ERROR;
 
+    if (sem->flags & SEM_F_SHARED) return semClose(sem);
+
+    semExtDetach(sem);
     if (sem->type == SEM_TYPE_MUTEX) {
         pthread_mutex_destroy(&sem->mutex);
     } else {
         sem_destroy(&sem->posixSem);
     }
-    free(sem);
+    if (!(sem->flags & SEM_F_STATIC)) free(sem);
+    return OK;
+}
+
+/**
+ * @brief Reports whether a semaphore can be taken right now, without taking it
+ */
+static int semIsFree(SEM_ID sem) {
+    if (sem->type == SEM_TYPE_MUTEX) {
+        if (pthread_mutex_trylock(&sem->mutex) != 0) return 0;
+        pthread_mutex_unlock(&sem->mutex);
+        // a virtual-time waiter may have failed its trylock meanwhile
+        if (tickVirtualModeGet()) semVirtGiven(sem);
+        return 1;
+    }
+    return semLooksAvailable(sem);
+}
+
+/**
+ * @brief Registers the calling task to receive events when a semaphore is given
+ *
+ * Every successful semGive() then sends @p events to the task, which can
+ * wait on many semaphores and message queues at once with eventReceive().
+ * Only one task can be registered per semaphore; calling again from the
+ * same task replaces its events and options.
+ *
+ * @param sem Semaphore to watch
+ * @param events Events to send (VXEV01..VXEV24)
+ * @param options EVENTS_SEND_ONCE, EVENTS_ALLOW_OVERWRITE and/or
+ *                EVENTS_SEND_IF_FREE, or EVENTS_OPTIONS_NONE
+ * @return int OK on success, ERROR if another task is registered without
+ *             EVENTS_ALLOW_OVERWRITE (errno EBUSY), for named semaphores
+ *             (ENOTSUP) or on invalid arguments
+ *
+ * @note The first registration of a semaphore allocates its extension block
+ *       (unless built with -DSEM_STATS, where every semaphore has one).
+ *       Until then semGive() pays for a single extra load.
+ */
+int semEvStart(SEM_ID sem, unsigned int events, int options) {
+    if (!sem) return ERROR;
+    if (sem->flags & SEM_F_SHARED) {
+        errno = ENOTSUP;
+        return ERROR;
+    }
+
+    pthread_mutex_lock(&g_extLock);
+    unsigned int idx = semExtAttachLocked(sem);
+    int rc = idx ? eventRsrcStart(&semExtGet(idx)->events, events, options) : ERROR;
+    pthread_mutex_unlock(&g_extLock);
+    if (idx == 0) errno = ENOMEM;
+
+    if (rc == OK && (options & EVENTS_SEND_IF_FREE) && semIsFree(sem)) {
+        eventRsrcSend(&semExtGet(idx)->events);
+    }
+    return rc;
+}
+
+/**
+ * @brief Stops sending events for a semaphore
+ *
+ * @param sem Semaphore passed to semEvStart()
+ * @return int OK on success, ERROR if the caller is not the registered task
+ *             (errno EPERM)
+ */
+int semEvStop(SEM_ID sem) {
+    if (!sem) return ERROR;
+    unsigned int idx = __atomic_load_n(&sem->extIdx, __ATOMIC_ACQUIRE);
+    if (!idx) {
+        errno = EPERM;
+        return ERROR;
+    }
+    pthread_mutex_lock(&g_extLock);
+    int rc = eventRsrcStop(&semExtGet(idx)->events);
+    pthread_mutex_unlock(&g_extLock);
+    return rc;
+}
+
+/**
+ * @brief Builds the shared memory object name for a named semaphore
+ */
+static int semShmName(const char* name, char* buf, size_t size) {
+    if (!name || !*name) return ERROR;
+    int n = snprintf(buf, size, "%s%s", name[0] == '/' ? "" : "/", name);
+    return (n > 0 && (size_t)n < size) ? OK : ERROR;
+}
+
+/**
+ * @brief Sets up a freshly created shared semaphore
+ */
+static int semSharedInit(SEM_ID s, int type, int options, int initial) {
+    memset(s, 0, sizeof(SEM_ID_STRUCT));
+    s->type = (unsigned char)type;
+    s->options = (unsigned short)(options & ~SEM_M_ADAPTIVE);
+
+    if (type == SEM_TYPE_MUTEX) {
+        pthread_mutexattr_t attr;
+        if (pthread_mutexattr_init(&attr) != 0) return ERROR;
+        int rc = pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        if (rc == 0) rc = pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+        if (rc == 0) rc = pthread_mutex_init(&s->mutex, &attr);
+        pthread_mutexattr_destroy(&attr);
+        if (rc != 0) return ERROR;
+    } else if (type == SEM_TYPE_BINARY || type == SEM_TYPE_COUNTING) {
+        unsigned int value = type == SEM_TYPE_BINARY ? (initial ? 1 : 0) : (unsigned int)initial;
+        if (initial < 0 || sem_init(&s->posixSem, 1, value) != 0) return ERROR;
+    } else {
+        return ERROR;
+    }
+    __atomic_store_n(&s->flags, (unsigned char)(SEM_F_SHARED | SEM_F_READY), __ATOMIC_RELEASE);
+    return OK;
+}
+
+/**
+ * @brief Opens or creates a named semaphore shared between processes
+ * 
+ * The first caller creates a POSIX shared memory object holding the
+ * semaphore, initialized process-shared; later callers (in any process)
+ * map the same object. Mutexes are additionally robust: if the owner dies
+ * while holding one, the next semTake() succeeds with errno EOWNERDEAD
+ * instead of blocking forever.
+ * 
+ * @param name Semaphore name (a leading '/' is added if missing)
+ * @param type SEM_TYPE_BINARY, SEM_TYPE_COUNTING or SEM_TYPE_MUTEX
+ * @param options Creation options (SEM_M_ADAPTIVE is ignored for shared semaphores)
+ * @param initial Initial state/count for binary/counting semaphores, ignored for mutexes
+ * @return SEM_ID usable with semTake/semGive, or NULL on failure or type mismatch
+ * 
+ * @note Statistics (-DSEM_STATS) are not collected for shared semaphores.
+ */
+SEM_ID semOpen(const char* name, int type, int options, int initial) {
+    char shmName[256];
+    if (semShmName(name, shmName, sizeof(shmName)) != OK) return NULL;
+
+    const size_t size = sizeof(SEM_ID_STRUCT_ALIGNED);
+    int creator = 1;
+    int fd = shm_open(shmName, O_RDWR | O_CREAT | O_EXCL, 0666);
+    if (fd < 0 && errno == EEXIST) {
+        creator = 0;
+        fd = shm_open(shmName, O_RDWR, 0666);
+    }
+    if (fd < 0) return NULL;
+
+    if (creator) {
+        if (ftruncate(fd, (off_t)size) != 0) {
+            close(fd);
+            shm_unlink(shmName);
+            return NULL;
+        }
+    } else {
+        /* Wait (up to ~1 s) for the creator to size the object */
+        struct stat st;
+        int tries = 0;
+        while (fstat(fd, &st) == 0 && (size_t)st.st_size < size && ++tries < 1000) usleep(1000);
+        if ((size_t)st.st_size < size) { close(fd); return NULL; }
+    }
+
+    SEM_ID s = (SEM_ID)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (s == (SEM_ID)MAP_FAILED) {
+        if (creator) shm_unlink(shmName);
+        return NULL;
+    }
+
+    if (creator) {
+        if (semSharedInit(s, type, options, initial) != OK) {
+            munmap(s, size);
+            shm_unlink(shmName);
+            return NULL;
+        }
+        return s;
+    }
+
+    /* Wait (up to ~1 s) for the creator to finish initialization */
+    for (int tries = 0; !(__atomic_load_n(&s->flags, __ATOMIC_ACQUIRE) & SEM_F_READY); tries++) {
+        if (tries >= 1000) { munmap(s, size); return NULL; }
+        usleep(1000);
+    }
+    if (s->type != type) {
+        munmap(s, size);
+        return NULL;
+    }
+    return s;
+}
+
+/**
+ * @brief Closes a named semaphore in the calling process
+ * 
+ * @param sem Semaphore returned by semOpen()
+ * @return int OK on success, ERROR on failure
+ * 
+ * @note The semaphore stays usable by other processes; use semUnlink() to
+ *       remove the name.
+ */
+int semClose(SEM_ID sem) {
+    if (!sem || !(sem->flags & SEM_F_SHARED)) return ERROR;
+    return munmap(sem, sizeof(SEM_ID_STRUCT_ALIGNED)) == 0 ? OK : ERROR;
+}
+
+/**
+ * @brief Removes the name of a semaphore created by semOpen()
+ * 
+ * @param name Semaphore name as passed to semOpen()
+ * @return int OK on success, ERROR on failure
+ * 
+ * @note Processes that still have the semaphore open keep using it; the
+ *       storage is released once the last one closes it.
+ */
+int semUnlink(const char* name) {
+    char shmName[256];
+    if (semShmName(name, shmName, sizeof(shmName)) != OK) return ERROR;
+    return shm_unlink(shmName) == 0 ? OK : ERROR;
+}
+
+/**
+ * @brief Enables or disables statistics collection at run time
+ *
+ * @param enable Non-zero to collect, zero to stop
+ * @return int OK, or ERROR if semLib was built without -DSEM_STATS
+ */
+int semStatsEnable(int enable) {
+#ifdef SEM_STATS
+    __atomic_store_n(&g_semStatsOn, enable ? 1 : 0, __ATOMIC_RELAXED);
+    return OK;
+#else
+    (void)enable;
+    return ERROR;
+#endif
+}
+
+/**
+ * @brief Copies the statistics of a semaphore
+ *
+ * @param sem Semaphore to query
+ * @param pStats Receives the snapshot (counters are read individually)
+ * @return int OK on success, ERROR if the semaphore has no statistics
+ */
+int semStatsGet(SEM_ID sem, SEM_STATS_INFO* pStats) {
+#ifdef SEM_STATS
+    if (!sem || !pStats || !sem->extIdx) return ERROR;
+    SemExt* ext = semExtGet(sem->extIdx);
+    pthread_mutex_lock(&ext->waiterLock);
+    *pStats = ext->stats;
+    pthread_mutex_unlock(&ext->waiterLock);
+    return OK;
+#else
+    (void)sem; (void)pStats;
+    return ERROR;
+#endif
+}
+
+#ifdef SEM_STATS
+/**
+ * @brief A semaphore and its total wait time, copied once for sorting
+ */
+typedef struct {
+    SEM_ID sem;
+    unsigned long long waitNs;
+} SemWaitKey;
+
+static int semWaitCompare(const void* a, const void* b) {
+    unsigned long long wa = ((const SemWaitKey*)a)->waitNs;
+    unsigned long long wb = ((const SemWaitKey*)b)->waitNs;
+    return wa < wb ? 1 : (wa > wb ? -1 : 0);
+}
+#endif
+
+/**
+ * @brief Lists live semaphores ordered by total wait time, largest first
+ *
+ * @param idList Receives up to maxSems semaphore ids
+ * @param maxSems Capacity of idList
+ * @return int Number of ids stored (0 if statistics are compiled out)
+ *
+ * @warning The ids are only valid as long as the semaphores are not deleted.
+ */
+int semStatsSortByWait(SEM_ID idList[], int maxSems) {
+#ifdef SEM_STATS
+    if (!idList || maxSems <= 0) return 0;
+
+    pthread_mutex_lock(&g_extLock);
+    size_t n = 0;
+    SemWaitKey* all = (SemWaitKey*)malloc(g_extNext * sizeof(SemWaitKey));
+    if (all) {
+        // waiters keep adding to waitNsTotal: sort a snapshot so the
+        // comparator sees the same value for a semaphore every time
+        for (unsigned int idx = 1; idx < g_extNext; idx++) {
+            SemExt* ext = semExtGet(idx);
+            if (!ext->sem) continue;
+            all[n].sem = ext->sem;
+            all[n].waitNs = __atomic_load_n(&ext->stats.waitNsTotal, __ATOMIC_RELAXED);
+            n++;
+        }
+        qsort(all, n, sizeof(SemWaitKey), semWaitCompare);
+        if (n > (size_t)maxSems) n = (size_t)maxSems;
+        for (size_t i = 0; i < n; i++) idList[i] = all[i].sem;
+        free(all);
+    }
+    pthread_mutex_unlock(&g_extLock);
+    return (int)n;
+#else
+    (void)idList; (void)maxSems;
+    return 0;
+#endif
+}
+
+/**
+ * @brief Prints a semaphore's state and, if available, its statistics
+ *
+ * @param sem Semaphore to show
+ * @param level 0 for a one-line summary, 1 to include histogram and waiters
+ * @return int OK on success, ERROR on invalid id
+ */
+int semShow(SEM_ID sem, int level) {
+    if (!sem) return ERROR;
+
+    static const char* const typeNames[] = { "?", "BINARY", "COUNTING", "MUTEX" };
+    const char* typeName = sem->type <= SEM_TYPE_MUTEX ? typeNames[sem->type] : "?";
+    int value = 0;
+    if (sem->type != SEM_TYPE_MUTEX) sem_getvalue(&sem->posixSem, &value);
+
+    printf("Semaphore %p  type %-8s options 0x%04x", (void*)sem, typeName, sem->options);
+    if (sem->type == SEM_TYPE_MUTEX) printf("\n");
+    else printf("  count %d\n", value);
+
+#ifdef SEM_STATS
+    SEM_STATS_INFO st;
+    if (semStatsGet(sem, &st) != OK) return OK;
+
+    printf("  acquisitions %llu  contended %llu  wait total %llu ns  max %llu ns\n",
+           st.acquisitions, st.contended, st.waitNsTotal, st.waitNsMax);
+    if (level < 1) return OK;
+
+    if (sem->type == SEM_TYPE_MUTEX) {
+        printf("  hold time histogram:\n");
+        for (int i = 0; i < SEM_HOLD_BUCKETS; i++) {
+            if (!st.holdHist[i]) continue;
+            if (i == 0) printf("    <  %10llu ns : %llu\n", 128ULL, st.holdHist[i]);
+            else if (i == SEM_HOLD_BUCKETS - 1) printf("    >= %10llu ns : %llu\n", 1ULL << (i + 6), st.holdHist[i]);
+            else printf("    <  %10llu ns : %llu\n", 1ULL << (i + 7), st.holdHist[i]);
+        }
+    }
+    for (int i = 0; i < SEM_TOP_WAITERS && st.topWaiters[i].tid; i++) {
+        printf("  waiter tid %-8d %llu ns\n", st.topWaiters[i].tid, st.topWaiters[i].waitNs);
+    }
+#else
+    (void)level;
+#endif
     return OK;
 }
 
+/**
+ * @brief Prints the statistics of the most contended live semaphores
+ *
+ * @param maxSems Maximum number of semaphores to print (<= 0 for all)
+ */
+void semStatsDump(int maxSems) {
+#ifdef SEM_STATS
+    if (maxSems <= 0) maxSems = SEM_EXT_CHUNK * SEM_EXT_CHUNKS;
+    pthread_mutex_lock(&g_extLock);
+    int live = (int)g_extNext;
+    pthread_mutex_unlock(&g_extLock);
+    if (maxSems > live) maxSems = live;
+
+    SEM_ID* ids = (SEM_ID*)malloc((size_t)maxSems * sizeof(SEM_ID));
+    if (!ids) return;
+    int n = semStatsSortByWait(ids, maxSems);
+    printf("semLib statistics (%s), %d semaphore(s) by total wait:\n",
+           g_semStatsOn ? "enabled" : "disabled", n);
+    for (int i = 0; i < n; i++) semShow(ids[i], 1);
+    free(ids);
+#else
+    (void)maxSems;
+    printf("semLib statistics not compiled in (build with -DSEM_STATS)\n");
+#endif
+}
+
 /** @} */ // end of semLib group
\ No newline at end of file
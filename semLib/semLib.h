@@ -47,6 +47,16 @@ extern "C" {
  */
 #define SEM_Q_PRIORITY 0x01
 
+/**
+ * @def SEM_M_ADAPTIVE
+ * @brief Adaptive spinning for mutex semaphores
+ *
+ * A contended semTake() spins for a bounded, self-tuning interval while the
+ * owner is still running before it parks in the kernel. Intended for very
+ * short critical sections. Ignored for binary and counting semaphores.
+ */
+#define SEM_M_ADAPTIVE 0x0100
+
 /**
  * @def OK
  * @brief Operation completed successfully
@@ -65,21 +75,98 @@ extern "C" {
  * 
  * This structure contains a type identifier and a union that holds
  * either a POSIX semaphore or a pthread mutex depending on the semaphore type.
+ * The owner/hold-time fields are only maintained for SEM_M_ADAPTIVE mutexes.
  */
 typedef struct {
-    int type;                       /**< Type of semaphore (BINARY, COUNTING, MUTEX) */
+    unsigned char type;             /**< Type of semaphore (BINARY, COUNTING, MUTEX) */
+    unsigned char flags;            /**< Internal state bits (SEM_F_*) */
+    unsigned short options;         /**< Creation options (SEM_Q_*, SEM_M_*) */
+    unsigned int holdNs;            /**< Average hold time (mutex) or semExchange reply latency (ns) */
     union {
         sem_t posixSem;             /**< POSIX semaphore for binary & counting semaphores */
         pthread_mutex_t mutex;      /**< pthread mutex for mutex semaphores */
     };
+    void* owner;                    /**< Run-state hint of the owning task, NULL if free */
+    unsigned int holdStart;         /**< Low 32 bits of the acquisition time (ns) */
+    unsigned int extIdx;            /**< Index of the extension block (events, statistics), 0 if none */
 } SEM_ID_STRUCT;
 
+/**
+ * @def SEM_F_STATIC
+ * @brief Internal flag: storage belongs to the caller (semXInit), not freed by semDelete
+ */
+#define SEM_F_STATIC 0x01
+
+/**
+ * @def SEM_F_SHARED
+ * @brief Internal flag: named process-shared semaphore living in shared memory (semOpen)
+ */
+#define SEM_F_SHARED 0x02
+
+/**
+ * @def SEM_F_READY
+ * @brief Internal flag: shared semaphore fully initialized by its creator
+ */
+#define SEM_F_READY  0x04
+
+/**
+ * @def SEM_CACHE_LINE
+ * @brief Cache line size used to isolate semaphores from their neighbours
+ */
+#define SEM_CACHE_LINE 64
+
+/**
+ * @struct SEM_ID_STRUCT_ALIGNED
+ * @brief SEM_ID_STRUCT aligned to and padded out to whole cache lines
+ *
+ * Embed this instead of a bare SEM_ID_STRUCT so that a semaphore never
+ * shares a cache line with unrelated hot data. Pass &x.sem to semXInit().
+ * Heap semaphores from semBCreate/semCCreate/semMCreate use the same layout.
+ */
+typedef struct {
+    SEM_ID_STRUCT sem;              /**< The semaphore itself */
+} __attribute__((aligned(SEM_CACHE_LINE))) SEM_ID_STRUCT_ALIGNED;
+
 /**
  * @typedef SEM_ID
  * @brief Opaque pointer to a semaphore structure
  */
 typedef SEM_ID_STRUCT* SEM_ID;
 
+/**
+ * @def SEM_HOLD_BUCKETS
+ * @brief Number of log2 hold-time histogram buckets
+ *
+ * Bucket 0 counts holds below 128 ns, bucket i holds in [2^(i+6), 2^(i+7)) ns,
+ * and the last bucket everything longer.
+ */
+#define SEM_HOLD_BUCKETS 20
+
+/**
+ * @def SEM_TOP_WAITERS
+ * @brief Number of heaviest waiting tasks tracked per semaphore
+ */
+#define SEM_TOP_WAITERS 4
+
+/**
+ * @struct SEM_STATS_INFO
+ * @brief Contention statistics snapshot returned by semStatsGet()
+ *
+ * Only available when semLib is built with -DSEM_STATS. Hold times are
+ * recorded for mutex semaphores only.
+ */
+typedef struct {
+    unsigned long long acquisitions;            /**< Successful takes */
+    unsigned long long contended;               /**< Takes that had to wait */
+    unsigned long long waitNsTotal;             /**< Total time spent waiting (ns) */
+    unsigned long long waitNsMax;               /**< Longest single wait (ns) */
+    unsigned long long holdHist[SEM_HOLD_BUCKETS]; /**< Hold-time histogram */
+    struct {
+        int tid;                                /**< Kernel thread id, 0 if unused */
+        unsigned long long waitNs;              /**< Accumulated wait of this task (ns) */
+    } topWaiters[SEM_TOP_WAITERS];              /**< Heaviest waiters, largest first */
+} SEM_STATS_INFO;
+
 // API Functions
 
 /**
@@ -100,18 +187,47 @@ SEM_ID semCCreate(int options, int initialCount);
 
 /**
  * @brief Creates a mutex semaphore
- * @param options Creation options (SEM_Q_FIFO or SEM_Q_PRIORITY)
+ * @param options Creation options (SEM_Q_FIFO or SEM_Q_PRIORITY, optionally
+ *                OR-ed with SEM_M_ADAPTIVE)
  * @return SEM_ID on success, NULL on failure
  */
 SEM_ID semMCreate(int options);
 
+/**
+ * @brief Initializes a binary semaphore in caller-provided storage
+ * @param pSem Storage for the semaphore (no heap allocation takes place)
+ * @param options Creation options (SEM_Q_FIFO or SEM_Q_PRIORITY)
+ * @param initialState Initial state of semaphore (0 = unavailable, 1 = available)
+ * @return OK on success, ERROR on failure
+ */
+int semBInit(SEM_ID_STRUCT* pSem, int options, int initialState);
+
+/**
+ * @brief Initializes a counting semaphore in caller-provided storage
+ * @param pSem Storage for the semaphore (no heap allocation takes place)
+ * @param options Creation options (SEM_Q_FIFO or SEM_Q_PRIORITY)
+ * @param initialCount Initial value of the semaphore counter
+ * @return OK on success, ERROR on failure
+ */
+int semCInit(SEM_ID_STRUCT* pSem, int options, int initialCount);
+
+/**
+ * @brief Initializes a mutex semaphore in caller-provided storage
+ * @param pSem Storage for the semaphore (no heap allocation takes place)
+ * @param options Creation options (SEM_Q_FIFO or SEM_Q_PRIORITY, SEM_M_ADAPTIVE)
+ * @return OK on success, ERROR on failure
+ */
+int semMInit(SEM_ID_STRUCT* pSem, int options);
+
 /**
  * @brief Attempts to acquire a semaphore
  * @param sem Semaphore to acquire
  * @param ticks Timeout specification:
  *              - -1: wait forever (block indefinitely)
  *              - 0: non-blocking, return immediately
- *              - >0: wait for specified number of ticks (approx 10ms per tick)
+ *              - >0: wait for specified number of ticks of tickLib's clock
+ *                (sysClkRateGet() per second, or virtual ticks in virtual
+ *                time mode, see tickVirtualModeSet())
  * @return OK on success, ERROR on failure or timeout
  */
 int semTake(SEM_ID sem, int ticks);
@@ -123,6 +239,19 @@ int semTake(SEM_ID sem, int ticks);
  */
 int semGive(SEM_ID sem);
 
+/**
+ * @brief Gives one semaphore and takes another as a single operation
+ * 
+ * Replaces the sequence semGive(give); semTake(take, ticks) in synchronous
+ * request/response code and avoids parking when the peer answers quickly.
+ * 
+ * @param give Semaphore to release
+ * @param take Semaphore to acquire afterwards
+ * @param ticks Timeout for the take, as for semTake()
+ * @return OK on success, ERROR on invalid ids, failed give or timeout
+ */
+int semExchange(SEM_ID give, SEM_ID take, int ticks);
+
 /**
  * @brief Deletes a semaphore and frees its resources
  * @param sem Semaphore to delete
@@ -130,6 +259,98 @@ int semGive(SEM_ID sem);
  */
 int semDelete(SEM_ID sem);
 
+/**
+ * @brief Registers the calling task to receive events on every semGive()
+ *
+ * One task can wait on many semaphores and message queues with a single
+ * eventReceive(). Event and option constants come from eventLib.h.
+ *
+ * @param sem Semaphore to watch (not a named semaphore from semOpen())
+ * @param events Events to send (VXEV01..VXEV24)
+ * @param options EVENTS_SEND_ONCE, EVENTS_ALLOW_OVERWRITE, EVENTS_SEND_IF_FREE
+ * @return OK on success, ERROR (errno EBUSY) if another task is registered
+ *         without EVENTS_ALLOW_OVERWRITE, ERROR on invalid arguments
+ */
+int semEvStart(SEM_ID sem, unsigned int events, int options);
+
+/**
+ * @brief Unregisters the calling task from a semaphore's events
+ * @param sem Semaphore passed to semEvStart()
+ * @return OK on success, ERROR (errno EPERM) if the caller is not registered
+ */
+int semEvStop(SEM_ID sem);
+
+/**
+ * @brief Opens or creates a named semaphore shared between processes
+ * 
+ * The semaphore lives in POSIX shared memory and is initialized
+ * process-shared; mutexes are robust, so a crashed owner is reported to the
+ * next semTake() (OK with errno EOWNERDEAD) instead of deadlocking it.
+ * semTake/semGive/semExchange work unchanged on the returned id.
+ * 
+ * @param name Semaphore name, e.g. "/mySem"
+ * @param type SEM_TYPE_BINARY, SEM_TYPE_COUNTING or SEM_TYPE_MUTEX
+ * @param options Creation options (SEM_M_ADAPTIVE is ignored)
+ * @param initial Initial state/count (binary/counting only)
+ * @return SEM_ID on success, NULL on failure or if an existing semaphore has another type
+ */
+SEM_ID semOpen(const char* name, int type, int options, int initial);
+
+/**
+ * @brief Closes a named semaphore in the calling process (semDelete does the same)
+ * @param sem Semaphore returned by semOpen()
+ * @return OK on success, ERROR on failure
+ */
+int semClose(SEM_ID sem);
+
+/**
+ * @brief Removes a semaphore name; the object goes away after the last close
+ * @param name Name passed to semOpen()
+ * @return OK on success, ERROR on failure
+ */
+int semUnlink(const char* name);
+
+/**
+ * @brief Enables or disables statistics collection at run time
+ *
+ * Semaphores created while semLib is built with -DSEM_STATS are always
+ * registered; this switch only controls whether they are counted.
+ *
+ * @param enable Non-zero to collect, zero to stop
+ * @return OK, or ERROR if statistics are compiled out
+ */
+int semStatsEnable(int enable);
+
+/**
+ * @brief Copies the statistics of a semaphore
+ * @param sem Semaphore to query
+ * @param pStats Receives the snapshot
+ * @return OK on success, ERROR if the semaphore has no statistics
+ */
+int semStatsGet(SEM_ID sem, SEM_STATS_INFO* pStats);
+
+/**
+ * @brief Lists live semaphores ordered by total wait time, largest first
+ * @param idList Receives up to maxSems semaphore ids
+ * @param maxSems Capacity of idList
+ * @return Number of ids stored
+ */
+int semStatsSortByWait(SEM_ID idList[], int maxSems);
+
+/**
+ * @brief Prints a semaphore's state and, if available, its statistics
+ * @param sem Semaphore to show
+ * @param level 0 for a one-line summary, 1 to include histogram and waiters
+ * @return OK on success, ERROR on invalid id
+ */
+int semShow(SEM_ID sem, int level);
+
+/**
+ * @brief Prints the statistics of the most contended live semaphores
+ * @param maxSems Maximum number of semaphores to print (<= 0 for all)
+ */
+void semStatsDump(int maxSems);
+
 #ifdef __cplusplus
 }
 #endif
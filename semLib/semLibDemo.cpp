@@ -5,6 +5,7 @@
  */
 
 #include "semLib.h"
+#include "eventLib.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -101,6 +102,33 @@ void* timeoutThread(void* arg) {
     return NULL;
 }
 
+/**
+ * @brief Thread function giving three event-registered semaphores in turn
+ */
+void* eventGiverThread(void* arg) {
+    SEM_ID* sems = (SEM_ID*)arg;
+    for (int i = 0; i < 3; i++) {
+        usleep(100000);
+        printf("Giver: giving semaphore %d\n", i);
+        semGive(sems[i]);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Server thread answering semExchange() requests
+ */
+void* exchangeServerThread(void* arg) {
+    SEM_ID* pair = (SEM_ID*)arg;   // [0] request, [1] reply
+    for (int i = 0; i < NUM_ITERATIONS; i++) {
+        semTake(pair[0], -1);
+        sharedCounter++;
+        printf("Server: handled request %d\n", i);
+        semGive(pair[1]);
+    }
+    return NULL;
+}
+
 /**
  * @brief Main function - demonstrates all semaphore types
  */
@@ -189,6 +217,52 @@ int main()
     // Wait for the timeout thread
     pthread_join(timeoutThreadHandle, NULL);
     
+    printf("\n5. Events: One Wait for Several Semaphores\n");
+    printf("------------------------------------------\n");
+    
+    SEM_ID evSems[3];
+    for (int i = 0; i < 3; i++) {
+        evSems[i] = semBCreate(SEM_Q_FIFO, 0);
+        semEvStart(evSems[i], VXEV01 << i, EVENTS_OPTIONS_NONE);
+    }
+    pthread_t giverHandle;
+    pthread_create(&giverHandle, NULL, eventGiverThread, evSems);
+    
+    for (int got = 0; got < 3; ) {
+        uint32_t events = 0;
+        eventReceive(VXEV01 | VXEV02 | VXEV03, EVENTS_WAIT_ANY, WAIT_FOREVER, &events);
+        for (int i = 0; i < 3; i++) {
+            if ((events & (VXEV01 << i)) && semTake(evSems[i], 0) == OK) {
+                printf("Main thread: event 0x%x, took semaphore %d\n", events, i);
+                got++;
+            }
+        }
+    }
+    pthread_join(giverHandle, NULL);
+    for (int i = 0; i < 3; i++) {
+        semEvStop(evSems[i]);
+        semDelete(evSems[i]);
+    }
+    
+    printf("\n6. Request/Response with semExchange\n");
+    printf("------------------------------------\n");
+    
+    SEM_ID pair[2] = { semBCreate(SEM_Q_FIFO, 0), semBCreate(SEM_Q_FIFO, 0) };
+    pthread_t serverHandle;
+    pthread_create(&serverHandle, NULL, exchangeServerThread, pair);
+    
+    for (int i = 0; i < NUM_ITERATIONS; i++) {
+        // Give the request and wait for the reply in one call
+        if (semExchange(pair[0], pair[1], 100) == OK) {
+            printf("Main thread: reply %d received, counter = %d\n", i, sharedCounter);
+        } else {
+            printf("Main thread: no reply to request %d\n", i);
+        }
+    }
+    pthread_join(serverHandle, NULL);
+    semDelete(pair[0]);
+    semDelete(pair[1]);
+    
     // Clean up
     semDelete(binarySem);
     semDelete(countingSem);
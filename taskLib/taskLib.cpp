@@ -0,0 +1,540 @@
+
+#include "taskLibP.h"
+#include "tickLib.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <time.h>
+#include <errno.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+/*
+ * A task is a pthread with a TASK_TCB on g_taskList. Spawned tasks are
+ * joinable: when one ends, its TCB moves to a zombie list and the next
+ * taskSpawn joins it and releases its stack, since a thread cannot unmap
+ * the stack it is running on. Threads the library did not create get a
+ * TCB on first use (taskTcbSelf), released by a thread-key destructor.
+ * Released TCBs go to a free list rather than back to the heap.
+ */
+
+static pthread_mutex_t g_taskLock = PTHREAD_MUTEX_INITIALIZER;
+static TASK_TCB* g_taskList = NULL;
+static TASK_TCB* g_taskZombies = NULL;      // ended, not yet joined
+static TASK_TCB* g_taskFree = NULL;         // released TCBs, reused by tcb_alloc
+static pthread_once_t g_taskOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t g_taskKey;             // adopted TCBs, freed at thread exit
+static cpu_set_t g_processCpus;             // affinity of a task without one
+static sigset_t g_suspendWait;              // everything blocked but TASK_SIG_RESUME
+static unsigned g_taskSeq = 0;              // for generated names
+static __thread TASK_TCB* t_taskSelf = NULL;
+
+static uint64_t task_mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* Sleep until CLOCK_MONOTONIC reaches @ns; a cancellation point */
+static void task_sleep_until(uint64_t ns) {
+    struct timespec ts;
+    ts.tv_sec = (time_t)(ns / 1000000000ULL);
+    ts.tv_nsec = (long)(ns % 1000000000ULL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;   // a suspend signal; the deadline stays absolute
+}
+
+/* VxWorks 0 (highest) .. 255 onto the policy's range, highest first */
+static int task_posix_prio(int policy, int vxPrio) {
+    int hi = sched_get_priority_max(policy);
+    int lo = sched_get_priority_min(policy);
+    return hi - (vxPrio * (hi - lo)) / TASK_PRIORITY_LOWEST;
+}
+
+static int task_vx_prio(int policy, int posixPrio) {
+    int hi = sched_get_priority_max(policy);
+    int lo = sched_get_priority_min(policy);
+    return hi > lo ? ((hi - posixPrio) * TASK_PRIORITY_LOWEST) / (hi - lo) : 0;
+}
+
+static void task_cpuset(cpuset_t affinity, cpu_set_t* set) {
+    if (affinity == 0) {
+        *set = g_processCpus;
+        return;
+    }
+    CPU_ZERO(set);
+    for (int cpu = 0; cpu < 64; cpu++)
+        if (CPUSET_ISSET(affinity, cpu)) CPU_SET(cpu, set);
+}
+
+static void task_sig_suspend(int sig) {
+    (void)sig;
+    TASK_TCB* tcb = t_taskSelf;
+    if (!tcb) return;
+    int savedErrno = errno;
+    __atomic_or_fetch(&tcb->state, TASK_STATE_SUSPEND, __ATOMIC_RELAXED);
+    while (__atomic_load_n(&tcb->suspended, __ATOMIC_ACQUIRE))
+        sigsuspend(&g_suspendWait);
+    __atomic_and_fetch(&tcb->state, ~TASK_STATE_SUSPEND, __ATOMIC_RELAXED);
+    errno = savedErrno;
+}
+
+static void task_sig_resume(int sig) {
+    (void)sig;      // only interrupts sigsuspend
+}
+
+static TASK_TCB* tcb_alloc(void) {
+    pthread_mutex_lock(&g_taskLock);
+    TASK_TCB* tcb = g_taskFree;
+    if (tcb) g_taskFree = tcb->next;
+    pthread_mutex_unlock(&g_taskLock);
+    if (!tcb) return (TASK_TCB*)calloc(1, sizeof(TASK_TCB));
+    // an eventSend through a stale ID may still check magic and OR into
+    // events, so those two are reset atomically; nothing else is shared
+    __atomic_store_n(&tcb->magic, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&tcb->events, 0, __ATOMIC_RELAXED);
+    tcb->next = NULL;
+    memset(&tcb->thread, 0, sizeof(*tcb) - offsetof(TASK_TCB, thread));
+    return tcb;
+}
+
+/* Caller holds g_taskLock */
+static void tcb_free_locked(TASK_TCB* tcb) {
+    tcb->next = g_taskFree;
+    g_taskFree = tcb;
+}
+
+/* Caller holds g_taskLock */
+static void task_list_add(TASK_TCB* tcb) {
+    tcb->next = g_taskList;
+    g_taskList = tcb;
+    __atomic_store_n(&tcb->magic, TASK_MAGIC, __ATOMIC_RELEASE);
+}
+
+/* Caller holds g_taskLock */
+static void task_list_remove(TASK_TCB* tcb) {
+    __atomic_store_n(&tcb->magic, 0, __ATOMIC_RELEASE);
+    for (TASK_TCB** pp = &g_taskList; *pp; pp = &(*pp)->next) {
+        if (*pp == tcb) {
+            *pp = tcb->next;
+            break;
+        }
+    }
+}
+
+static void task_key_dtor(void* p) {
+    TASK_TCB* tcb = (TASK_TCB*)p;
+    pthread_mutex_lock(&g_taskLock);
+    task_list_remove(tcb);
+    tcb_free_locked(tcb);
+    pthread_mutex_unlock(&g_taskLock);
+}
+
+static void task_init(void) {
+    pthread_key_create(&g_taskKey, task_key_dtor);
+    if (sched_getaffinity(0, sizeof(g_processCpus), &g_processCpus) != 0) {
+        CPU_ZERO(&g_processCpus);
+        for (int i = 0; i < CPU_SETSIZE; i++) CPU_SET(i, &g_processCpus);
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = task_sig_suspend;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    sigaddset(&sa.sa_mask, TASK_SIG_RESUME);    // only let it in inside sigsuspend
+    sigaction(TASK_SIG_SUSPEND, &sa, NULL);
+    sa.sa_handler = task_sig_resume;
+    sigemptyset(&sa.sa_mask);
+    sigaction(TASK_SIG_RESUME, &sa, NULL);
+
+    sigfillset(&g_suspendWait);
+    sigdelset(&g_suspendWait, TASK_SIG_RESUME);
+}
+
+TASK_TCB* taskTcbSelf(void) {
+    if (t_taskSelf) return t_taskSelf;
+    pthread_once(&g_taskOnce, task_init);
+    TASK_TCB* tcb = tcb_alloc();
+    if (!tcb) return NULL;
+
+    int policy;
+    struct sched_param sp;
+    tcb->thread = pthread_self();
+    tcb->adopted = 1;
+    if (pthread_getschedparam(tcb->thread, &policy, &sp) == 0 &&
+        (policy == SCHED_FIFO || policy == SCHED_RR)) {
+        tcb->policy = policy;
+        tcb->rt = 1;
+        tcb->priority = task_vx_prio(policy, sp.sched_priority);
+    } else {
+        tcb->policy = SCHED_FIFO;   // used if taskPrioritySet is called
+        tcb->priority = TASK_PRIORITY_LOWEST;
+    }
+
+    pthread_mutex_lock(&g_taskLock);
+    if (getpid() == (pid_t)syscall(SYS_gettid)) snprintf(tcb->name, sizeof(tcb->name), "tMain");
+    else snprintf(tcb->name, sizeof(tcb->name), "tThread%u", ++g_taskSeq);
+    task_list_add(tcb);
+    pthread_mutex_unlock(&g_taskLock);
+
+    pthread_setspecific(g_taskKey, tcb);
+    t_taskSelf = tcb;
+    return tcb;
+}
+
+TASK_TCB* taskTcbLock(TASK_ID tid) {
+    TASK_TCB* want = tid ? (TASK_TCB*)tid : taskTcbSelf();
+    if (!want) return NULL;
+    pthread_mutex_lock(&g_taskLock);
+    for (TASK_TCB* t = g_taskList; t; t = t->next) {
+        if (t == want) return t;
+    }
+    pthread_mutex_unlock(&g_taskLock);
+    return NULL;
+}
+
+void taskTcbUnlock(void) {
+    pthread_mutex_unlock(&g_taskLock);
+}
+
+/* Join ended tasks and release their stacks */
+static void task_reap(void) {
+    pthread_mutex_lock(&g_taskLock);
+    TASK_TCB* z = g_taskZombies;
+    g_taskZombies = NULL;
+    pthread_mutex_unlock(&g_taskLock);
+
+    while (z) {
+        TASK_TCB* next = z->next;
+        pthread_join(z->thread, NULL);
+        if (z->stackMem) munmap(z->stackMem, z->stackMemSize);
+        pthread_mutex_lock(&g_taskLock);
+        tcb_free_locked(z);
+        pthread_mutex_unlock(&g_taskLock);
+        z = next;
+    }
+}
+
+/* Cleanup of a spawned task however it ends: return, taskDelete or cancel */
+static void task_exit(void* p) {
+    TASK_TCB* tcb = (TASK_TCB*)p;
+    pthread_mutex_lock(&g_taskLock);
+    task_list_remove(tcb);
+    tcb->next = g_taskZombies;
+    g_taskZombies = tcb;
+    pthread_mutex_unlock(&g_taskLock);
+}
+
+static void* task_trampoline(void* p) {
+    TASK_TCB* tcb = (TASK_TCB*)p;
+    t_taskSelf = tcb;
+
+    sigset_t sigs;
+    sigemptyset(&sigs);
+    sigaddset(&sigs, TASK_SIG_SUSPEND);
+    sigaddset(&sigs, TASK_SIG_RESUME);
+    pthread_sigmask(SIG_UNBLOCK, &sigs, NULL);
+
+    // do not inherit the spawning thread's CPU set
+    cpu_set_t set;
+    task_cpuset(0, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    char comm[16];
+    snprintf(comm, sizeof(comm), "%.15s", tcb->name);
+    pthread_setname_np(pthread_self(), comm);
+
+    pthread_cleanup_push(task_exit, tcb);
+    const uintptr_t* a = tcb->args;
+    tcb->entry(a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7], a[8], a[9]);
+    pthread_cleanup_pop(1);
+    return NULL;
+}
+
+/* Prefaulted stack with a guard page below it, locked into memory if the
+   memlock limit allows; a refused mlock still leaves it prefaulted */
+static int task_stack_alloc(TASK_TCB* tcb, size_t size) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size = (size + page - 1) & ~(page - 1);
+    size_t total = size + page;
+    void* mem = mmap(NULL, total, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK | MAP_POPULATE, -1, 0);
+    if (mem == MAP_FAILED) return -1;
+    mprotect(mem, page, PROT_NONE);
+    tcb->stackMem = mem;
+    tcb->stackMemSize = total;
+    tcb->stackSize = size;
+    tcb->stackLocked = mlock((char*)mem + page, size) == 0;
+    return 0;
+}
+
+TASK_ID taskSpawn(const char* name, int priority, int options, size_t stackSize,
+                  TASK_FUNC entry,
+                  uintptr_t arg1, uintptr_t arg2, uintptr_t arg3, uintptr_t arg4,
+                  uintptr_t arg5, uintptr_t arg6, uintptr_t arg7, uintptr_t arg8,
+                  uintptr_t arg9, uintptr_t arg10) {
+    if (!entry || priority < TASK_PRIORITY_HIGHEST || priority > TASK_PRIORITY_LOWEST) {
+        errno = EINVAL;
+        return NULL;
+    }
+    pthread_once(&g_taskOnce, task_init);
+    task_reap();
+
+    TASK_TCB* tcb = tcb_alloc();
+    if (!tcb) return NULL;
+    tcb->priority = priority;
+    tcb->options = options;
+    tcb->policy = (options & VX_TASK_RR) ? SCHED_RR : SCHED_FIFO;
+    tcb->entry = entry;
+    uintptr_t args[10] = { arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8, arg9, arg10 };
+    memcpy(tcb->args, args, sizeof(args));
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    size_t size = stackSize;
+    if ((options & VX_TASK_LOCKED_STACK) && size == 0) size = TASK_STACK_LOCKED_DEFAULT;
+    if (size != 0 && size < TASK_STACK_MIN) size = TASK_STACK_MIN;
+    if (options & VX_TASK_LOCKED_STACK) {
+        if (task_stack_alloc(tcb, size) != 0) {
+            pthread_attr_destroy(&attr);
+            pthread_mutex_lock(&g_taskLock);
+            tcb_free_locked(tcb);
+            pthread_mutex_unlock(&g_taskLock);
+            return NULL;
+        }
+        size_t guard = tcb->stackMemSize - tcb->stackSize;
+        pthread_attr_setstack(&attr, (char*)tcb->stackMem + guard, tcb->stackSize);
+    } else if (size != 0) {
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        tcb->stackSize = (size + page - 1) & ~(page - 1);
+        pthread_attr_setstacksize(&attr, tcb->stackSize);
+    }
+
+    struct sched_param sp;
+    memset(&sp, 0, sizeof(sp));
+    sp.sched_priority = task_posix_prio(tcb->policy, priority);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, tcb->policy);
+    pthread_attr_setschedparam(&attr, &sp);
+
+    pthread_mutex_lock(&g_taskLock);
+    if (name) snprintf(tcb->name, sizeof(tcb->name), "%s", name);
+    else snprintf(tcb->name, sizeof(tcb->name), "t%u", ++g_taskSeq);
+    tcb->rt = 1;
+    int rc = pthread_create(&tcb->thread, &attr, task_trampoline, tcb);
+    if (rc == EPERM) {
+        // no real-time privilege: run under the default policy instead
+        pthread_attr_setinheritsched(&attr, PTHREAD_INHERIT_SCHED);
+        tcb->rt = 0;
+        rc = pthread_create(&tcb->thread, &attr, task_trampoline, tcb);
+    }
+    if (rc == 0) task_list_add(tcb);
+    pthread_mutex_unlock(&g_taskLock);
+    pthread_attr_destroy(&attr);
+
+    if (rc != 0) {
+        if (tcb->stackMem) munmap(tcb->stackMem, tcb->stackMemSize);
+        pthread_mutex_lock(&g_taskLock);
+        tcb_free_locked(tcb);
+        pthread_mutex_unlock(&g_taskLock);
+        errno = rc;
+        return NULL;
+    }
+    return tcb;
+}
+
+int taskDelete(TASK_ID tid) {
+    TASK_TCB* tcb = taskTcbLock(tid);
+    if (!tcb) return ERROR;
+    if (pthread_equal(tcb->thread, pthread_self())) {
+        taskTcbUnlock();
+        pthread_exit(NULL);
+    }
+    pthread_cancel(tcb->thread);
+    if (__atomic_exchange_n(&tcb->suspended, 0, __ATOMIC_RELEASE))
+        pthread_kill(tcb->thread, TASK_SIG_RESUME);    // let it reach a cancellation point
+    taskTcbUnlock();
+    return OK;
+}
+
+TASK_ID taskIdSelf(void) {
+    return taskTcbSelf();
+}
+
+int taskIdVerify(TASK_ID tid) {
+    if (!tid || !taskTcbLock(tid)) return ERROR;
+    taskTcbUnlock();
+    return OK;
+}
+
+int taskDelay(int ticks) {
+    if (ticks < 0) {
+        errno = EINVAL;
+        return ERROR;
+    }
+    if (ticks == 0) {
+        sched_yield();
+        return OK;
+    }
+
+    TASK_TCB* self = t_taskSelf;
+    if (self) __atomic_or_fetch(&self->state, TASK_STATE_DELAY, __ATOMIC_RELAXED);
+    uint64_t target = tickGet() + (uint64_t)ticks;
+    uint64_t last = tickGet();
+    while (last < target) {
+        uint64_t ns;
+        int virt = tickVirtualModeGet();
+        if (virt) {
+            ns = TICK_VIRTUAL_POLL_MS * 1000000ULL;
+        } else {
+            // sleep to where the tick clock should reach the target, then
+            // re-check so the delay ends on the tick count, not on our estimate
+            int rate = sysClkRateGet();
+            uint64_t tps = rate > 0 ? (uint64_t)rate : 60;
+            ns = ((target - last) * 1000000000ULL + tps - 1) / tps;
+        }
+        task_sleep_until(task_mono_ns() + ns);
+        uint64_t now = tickGet();
+        if (!virt && now == last) break;   // no tick source running: the time has passed
+        last = now;
+    }
+    if (self) __atomic_and_fetch(&self->state, ~TASK_STATE_DELAY, __ATOMIC_RELAXED);
+    return OK;
+}
+
+int taskPrioritySet(TASK_ID tid, int newPriority) {
+    if (newPriority < TASK_PRIORITY_HIGHEST || newPriority > TASK_PRIORITY_LOWEST) return ERROR;
+    TASK_TCB* tcb = taskTcbLock(tid);
+    if (!tcb) return ERROR;
+    struct sched_param sp;
+    memset(&sp, 0, sizeof(sp));
+    sp.sched_priority = task_posix_prio(tcb->policy, newPriority);
+    int rc = pthread_setschedparam(tcb->thread, tcb->policy, &sp);
+    if (rc == 0) tcb->rt = 1;
+    else if (rc == EPERM) tcb->rt = 0;      // keep the VxWorks priority, run as before
+    if (rc == 0 || rc == EPERM) tcb->priority = newPriority;
+    taskTcbUnlock();
+    return rc == 0 || rc == EPERM ? OK : ERROR;
+}
+
+int taskPriorityGet(TASK_ID tid, int* pPriority) {
+    if (!pPriority) return ERROR;
+    TASK_TCB* tcb = taskTcbLock(tid);
+    if (!tcb) return ERROR;
+    *pPriority = tcb->priority;
+    taskTcbUnlock();
+    return OK;
+}
+
+int taskSuspend(TASK_ID tid) {
+    TASK_TCB* tcb = taskTcbLock(tid);
+    if (!tcb) return ERROR;
+    __atomic_store_n(&tcb->suspended, 1, __ATOMIC_RELEASE);
+    pthread_t thread = tcb->thread;
+    int self = pthread_equal(thread, pthread_self());
+    int rc = 0;
+    if (!self) rc = pthread_kill(thread, TASK_SIG_SUSPEND);
+    taskTcbUnlock();
+    if (self) rc = pthread_kill(thread, TASK_SIG_SUSPEND);  // returns once resumed
+    return rc == 0 ? OK : ERROR;
+}
+
+int taskResume(TASK_ID tid) {
+    TASK_TCB* tcb = taskTcbLock(tid);
+    if (!tcb) return ERROR;
+    int rc = 0;
+    if (__atomic_exchange_n(&tcb->suspended, 0, __ATOMIC_RELEASE))
+        rc = pthread_kill(tcb->thread, TASK_SIG_RESUME);
+    taskTcbUnlock();
+    return rc == 0 ? OK : ERROR;
+}
+
+int taskIsSuspended(TASK_ID tid) {
+    TASK_TCB* tcb = taskTcbLock(tid);
+    if (!tcb) return 0;
+    int s = __atomic_load_n(&tcb->suspended, __ATOMIC_ACQUIRE);
+    taskTcbUnlock();
+    return s;
+}
+
+int taskCpuAffinitySet(TASK_ID tid, cpuset_t affinity) {
+    TASK_TCB* tcb = taskTcbLock(tid);
+    if (!tcb) return ERROR;
+    cpu_set_t set;
+    task_cpuset(affinity, &set);
+    int rc = pthread_setaffinity_np(tcb->thread, sizeof(set), &set);
+    if (rc == 0) tcb->affinity = affinity;
+    taskTcbUnlock();
+    return rc == 0 ? OK : ERROR;
+}
+
+int taskCpuAffinityGet(TASK_ID tid, cpuset_t* pAffinity) {
+    if (!pAffinity) return ERROR;
+    TASK_TCB* tcb = taskTcbLock(tid);
+    if (!tcb) return ERROR;
+    *pAffinity = tcb->affinity;
+    taskTcbUnlock();
+    return OK;
+}
+
+const char* taskName(TASK_ID tid) {
+    TASK_TCB* tcb = taskTcbLock(tid);
+    if (!tcb) return NULL;
+    const char* name = tcb->name;
+    taskTcbUnlock();
+    return name;
+}
+
+TASK_ID taskNameToId(const char* name) {
+    if (!name) return NULL;
+    pthread_mutex_lock(&g_taskLock);
+    TASK_TCB* t = g_taskList;
+    while (t && strcmp(t->name, name) != 0) t = t->next;
+    pthread_mutex_unlock(&g_taskLock);
+    return t;
+}
+
+/* Caller holds g_taskLock */
+static void task_show_one(const TASK_TCB* tcb) {
+    int state = __atomic_load_n(&tcb->state, __ATOMIC_RELAXED);
+    char st[32] = "";
+    if (state & TASK_STATE_SUSPEND) strcat(st, "SUSP+");
+    if (state & TASK_STATE_PEND) strcat(st, "PEND+");
+    if (state & TASK_STATE_DELAY) strcat(st, "DELAY+");
+    if (st[0]) st[strlen(st) - 1] = '\0';
+    else strcpy(st, "READY");
+
+    char policy[16];
+    if (!tcb->rt) snprintf(policy, sizeof(policy), "OTHER");
+    else snprintf(policy, sizeof(policy), "%s/%d", tcb->policy == SCHED_RR ? "RR" : "FIFO",
+                  task_posix_prio(tcb->policy, tcb->priority));
+
+    char stack[32];
+    if (tcb->stackSize == 0) snprintf(stack, sizeof(stack), "default");
+    else snprintf(stack, sizeof(stack), "%zuK%s", tcb->stackSize / 1024,
+                  tcb->stackMem ? (tcb->stackLocked ? " locked" : " prefault") : "");
+
+    printf("%-16s %-18p %4d %-9s %-14s %#18llx  %s\n", tcb->name, (const void*)tcb,
+           tcb->priority, policy, st, (unsigned long long)tcb->affinity, stack);
+}
+
+void taskShow(TASK_ID tid) {
+    printf("%-16s %-18s %4s %-9s %-14s %18s  %s\n",
+           "NAME", "TID", "PRI", "POLICY", "STATUS", "CPUS", "STACK");
+    if (tid) {
+        TASK_TCB* tcb = taskTcbLock(tid);
+        if (!tcb) return;
+        task_show_one(tcb);
+        taskTcbUnlock();
+        return;
+    }
+    pthread_mutex_lock(&g_taskLock);
+    for (TASK_TCB* t = g_taskList; t; t = t->next) task_show_one(t);
+    pthread_mutex_unlock(&g_taskLock);
+}
@@ -0,0 +1,190 @@
+/**
+ * @file taskLib.h
+ * @brief VxWorks-like task library on top of POSIX threads.
+ *
+ * Each task is a pthread. VxWorks priorities 0 (highest) to 255 (lowest)
+ * are mapped linearly onto the SCHED_FIFO (or, with ::VX_TASK_RR,
+ * SCHED_RR) priority range. When the process may not use real-time
+ * scheduling (EPERM) tasks are created with the default policy instead and
+ * the task library keeps the VxWorks priority for ::taskPriorityGet.
+ *
+ * ::taskDelay counts ticks of tickLib's clock, including virtual time.
+ * ::taskSuspend and ::taskResume use two real-time signals
+ * (::TASK_SIG_SUSPEND, ::TASK_SIG_RESUME) that the application must not
+ * use for anything else.
+ */
+
+#ifndef __INCtaskLibh
+#define __INCtaskLibh
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup taskLib Task Library
+ *  @brief Emulation of VxWorks task management.
+ *  @{
+ */
+
+#ifndef OK
+#define OK 0
+#endif
+#ifndef ERROR
+#define ERROR -1
+#endif
+
+/** Task ID: the address of the task's control block. TCBs are reused, so
+    the ID of a task that has ended may later name a new task. */
+typedef void* TASK_ID;
+
+/** Task entry point; receives the ten arguments given to ::taskSpawn. */
+typedef int (*TASK_FUNC)(uintptr_t, uintptr_t, uintptr_t, uintptr_t, uintptr_t,
+                         uintptr_t, uintptr_t, uintptr_t, uintptr_t, uintptr_t);
+
+/** CPU set for ::taskCpuAffinitySet, one bit per CPU (CPUs 0-63). */
+typedef uint64_t cpuset_t;
+#define CPUSET_ZERO(set)        ((set) = 0)
+#define CPUSET_SET(set, cpu)    ((set) |= (1ULL << (cpu)))
+#define CPUSET_CLR(set, cpu)    ((set) &= ~(1ULL << (cpu)))
+#define CPUSET_ISSET(set, cpu)  (((set) >> (cpu)) & 1ULL)
+
+#define TASK_PRIORITY_HIGHEST   0
+#define TASK_PRIORITY_LOWEST    255
+#define TASK_NAME_LEN           32
+
+/* taskSpawn options. VxWorks options without a meaning here are accepted
+   and ignored. */
+#define VX_UNBREAKABLE          0x0002
+#define VX_FP_TASK              0x0008
+#define VX_NO_STACK_FILL        0x0100
+#define VX_TASK_RR              0x01000000  /**< SCHED_RR instead of SCHED_FIFO */
+#define VX_TASK_LOCKED_STACK    0x02000000  /**< prefaulted, mlock()ed stack for RT tasks */
+
+/** Smallest stack given to a task; VxWorks stack sizes are too small for glibc. */
+#define TASK_STACK_MIN          (64 * 1024)
+/** Stack size used with ::VX_TASK_LOCKED_STACK when @c stackSize is 0. */
+#define TASK_STACK_LOCKED_DEFAULT (256 * 1024)
+
+/**
+ * @brief Create and start a task.
+ *
+ * @param name Task name (copied, truncated to ::TASK_NAME_LEN - 1), or NULL
+ *        for a generated "tN" name.
+ * @param priority VxWorks priority, 0 (highest) to 255 (lowest).
+ * @param options VX_* options.
+ * @param stackSize Stack size in bytes, 0 for the default; raised to
+ *        ::TASK_STACK_MIN.
+ * @param entry Entry point; the task ends when it returns.
+ * @return Task ID, or NULL on error.
+ */
+TASK_ID taskSpawn (const char *name, int priority, int options, size_t stackSize,
+                   TASK_FUNC entry,
+                   uintptr_t arg1, uintptr_t arg2, uintptr_t arg3, uintptr_t arg4,
+                   uintptr_t arg5, uintptr_t arg6, uintptr_t arg7, uintptr_t arg8,
+                   uintptr_t arg9, uintptr_t arg10);
+
+/**
+ * @brief Delete a task.
+ *
+ * Deleting the calling task (or NULL) ends it at once. Another task is
+ * cancelled and ends at its next cancellation point (a blocking call such
+ * as ::taskDelay or a semaphore wait).
+ *
+ * @return OK, or ERROR if @p tid is not a task.
+ */
+int taskDelete (TASK_ID tid);
+
+/**
+ * @brief ID of the calling task.
+ *
+ * Threads not created by ::taskSpawn (for example main) get a task ID on
+ * first use, so every task-level API works from them too.
+ */
+TASK_ID taskIdSelf (void);
+
+/**
+ * @brief Check that @p tid names a live task.
+ *
+ * @return OK or ERROR.
+ */
+int taskIdVerify (TASK_ID tid);
+
+/**
+ * @brief Delay the calling task for @p ticks ticks of tickLib's clock.
+ *
+ * 0 yields the CPU. In virtual time the delay ends when ::tickAdvance has
+ * moved the count far enough.
+ *
+ * @return OK, or ERROR if @p ticks is negative.
+ */
+int taskDelay (int ticks);
+
+/**
+ * @brief Change a task's VxWorks priority.
+ *
+ * @return OK, or ERROR on a bad ID or priority.
+ */
+int taskPrioritySet (TASK_ID tid, int newPriority);
+
+/**
+ * @brief Get a task's VxWorks priority.
+ */
+int taskPriorityGet (TASK_ID tid, int *pPriority);
+
+/**
+ * @brief Stop a task until ::taskResume. Suspending the caller (NULL)
+ *        returns only after another task resumed it.
+ *
+ * A task suspended while it holds a lock keeps holding it.
+ */
+int taskSuspend (TASK_ID tid);
+
+/**
+ * @brief Let a suspended task continue.
+ */
+int taskResume (TASK_ID tid);
+
+/**
+ * @brief Check whether a task is suspended.
+ *
+ * @return 1 if suspended, 0 if not or not a task.
+ */
+int taskIsSuspended (TASK_ID tid);
+
+/**
+ * @brief Restrict a task to the CPUs in @p affinity (0 = all CPUs).
+ */
+int taskCpuAffinitySet (TASK_ID tid, cpuset_t affinity);
+
+/**
+ * @brief Get the CPU set last given to ::taskCpuAffinitySet (0 = all CPUs).
+ */
+int taskCpuAffinityGet (TASK_ID tid, cpuset_t *pAffinity);
+
+/**
+ * @brief Name of a task, or NULL if @p tid is not a task.
+ */
+const char *taskName (TASK_ID tid);
+
+/**
+ * @brief Find a task by name.
+ *
+ * @return Task ID, or NULL if there is none.
+ */
+TASK_ID taskNameToId (const char *name);
+
+/**
+ * @brief Print one task, or every task when @p tid is NULL.
+ */
+void taskShow (TASK_ID tid);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INCtaskLibh */
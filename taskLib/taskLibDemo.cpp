@@ -0,0 +1,92 @@
+/**
+ * @file taskLibDemo.cpp
+ * @brief Demo application for the task library
+ * @details Spawns tasks at different VxWorks priorities, delays them on the
+ * tick clock, suspends and resumes one of them, pins one to a CPU and
+ * prints the task table.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include "taskLib.h"
+#include "tickLib.h"
+
+static volatile int g_counter = 0;
+
+/**
+ * @brief Periodic worker: counts and prints every @p period ticks
+ */
+static int worker(uintptr_t name, uintptr_t period, uintptr_t rounds,
+                  uintptr_t, uintptr_t, uintptr_t, uintptr_t, uintptr_t, uintptr_t, uintptr_t) {
+    for (uintptr_t i = 0; i < rounds; i++) {
+        g_counter++;
+        printf("%s: round %lu at tick %llu\n", (const char*)name, (unsigned long)i,
+               (unsigned long long)tickGet());
+        taskDelay((int)period);
+    }
+    return 0;
+}
+
+/**
+ * @brief Spins until suspended; shows that a suspended task stops counting
+ */
+static int spinner(uintptr_t pCount, uintptr_t, uintptr_t, uintptr_t, uintptr_t,
+                   uintptr_t, uintptr_t, uintptr_t, uintptr_t, uintptr_t) {
+    volatile unsigned long* count = (volatile unsigned long*)pCount;
+    for (;;) {
+        (*count)++;
+        taskDelay(1);
+    }
+    return 0;
+}
+
+int main() {
+    printf("Task Library Example\n");
+    printf("====================\n\n");
+
+    tickLibInit(100);
+
+    TASK_ID fast = taskSpawn("tFast", 50, VX_FP_TASK, 0, worker,
+                             (uintptr_t)"tFast", 10, 5, 0, 0, 0, 0, 0, 0, 0);
+    TASK_ID slow = taskSpawn("tSlow", 150, VX_TASK_LOCKED_STACK, 0, worker,
+                             (uintptr_t)"tSlow", 25, 2, 0, 0, 0, 0, 0, 0, 0);
+    static volatile unsigned long spins = 0;
+    TASK_ID spin = taskSpawn("tSpin", 200, 0, 64 * 1024, spinner,
+                             (uintptr_t)&spins, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    if (!fast || !slow || !spin) {
+        printf("taskSpawn failed\n");
+        return 1;
+    }
+
+    cpuset_t cpus;
+    CPUSET_ZERO(cpus);
+    CPUSET_SET(cpus, 0);
+    taskCpuAffinitySet(spin, cpus);
+
+    taskDelay(5);
+    printf("\n");
+    taskShow(NULL);
+    printf("\n");
+
+    taskSuspend(spin);
+    unsigned long before = spins;
+    taskDelay(20);
+    printf("tSpin suspended: %lu -> %lu spins (suspended=%d)\n", before, spins, taskIsSuspended(spin));
+    taskResume(spin);
+    taskDelay(20);
+    printf("tSpin resumed: %lu spins\n", spins);
+
+    taskPrioritySet(spin, 100);
+    int prio = -1;
+    taskPriorityGet(spin, &prio);
+    printf("tSpin priority now %d, found by name: %s\n\n", prio,
+           taskNameToId("tSpin") == spin ? "yes" : "no");
+
+    taskDelay(60);
+    taskDelete(spin);
+    printf("\nworker rounds: %d\n", g_counter);
+
+    tickLibShutdown();
+    printf("\nExample completed\n");
+    return 0;
+}
@@ -0,0 +1,69 @@
+/**
+ * @file taskLibP.h
+ * @brief Private task control block, for libraries that keep per-task state.
+ */
+#ifndef __INCtaskLibPh
+#define __INCtaskLibPh
+
+#include "taskLib.h"
+
+#include <pthread.h>
+#include <signal.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Signals used by taskSuspend / taskResume */
+#define TASK_SIG_SUSPEND    (SIGRTMIN + 4)
+#define TASK_SIG_RESUME     (SIGRTMIN + 5)
+
+#define TASK_MAGIC          0x7a5b7cb0u     // TASK_TCB.magic while the task lives
+
+/* TASK_TCB.state bits */
+#define TASK_STATE_READY    0x0
+#define TASK_STATE_DELAY    0x1
+#define TASK_STATE_SUSPEND  0x2
+#define TASK_STATE_PEND     0x4
+
+/* TCB memory is never returned to the heap, only reused for later tasks,
+   so a stale TASK_ID can be checked through magic without the list lock.
+   A stale ID whose TCB has been reused names the new task. magic and
+   events are accessed without the lock and come before thread: tcb_alloc
+   clears them atomically and the fields from thread on with memset. */
+typedef struct TASK_TCB {
+    struct TASK_TCB* next;          // on the task list, then the zombie list, then the free list
+    unsigned    magic;              // TASK_MAGIC while on the task list; atomic
+    uint32_t    events;             // eventLib register and futex word; atomic
+    pthread_t   thread;
+    char        name[TASK_NAME_LEN];
+    int         priority;           // VxWorks priority
+    int         options;
+    int         policy;             // SCHED_FIFO or SCHED_RR
+    int         rt;                 // 0 while running under SCHED_OTHER (RT refused or never set)
+    int         adopted;            // thread not created by taskSpawn
+    int         suspended;          // taskSuspend requested; atomic
+    int         state;              // TASK_STATE_* bits; atomic
+    cpuset_t    affinity;
+    void*       stackMem;           // mmap()ed stack incl. guard page, or NULL
+    size_t      stackMemSize;
+    size_t      stackSize;
+    int         stackLocked;
+    TASK_FUNC   entry;
+    uintptr_t   args[10];
+} TASK_TCB;
+
+/* TCB of the calling thread, created on first use for threads not spawned */
+TASK_TCB* taskTcbSelf(void);
+
+/* Verified TCB of @tid (NULL = caller) with the task list locked, or NULL
+   with the list unlocked. Release with taskTcbUnlock(). The task cannot
+   exit while the list is locked. */
+TASK_TCB* taskTcbLock(TASK_ID tid);
+void      taskTcbUnlock(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INCtaskLibPh */
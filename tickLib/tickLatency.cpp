@@ -0,0 +1,196 @@
+/**
+ * @file tickLatency.cpp
+ * @brief Tick jitter and latency benchmark for tickLib (cyclictest-style).
+ *
+ * Registers a tick hook that timestamps every ::tickAnnounce and compares
+ * it with the deadline tickLib programmed for that tick (epoch + n / rate,
+ * from ::tickAnnounceDueNs), so a late first tick does not shift the
+ * reference for all others. The difference goes into a lock-free
+ * histogram with 1 us buckets. At the end
+ * the program prints min/avg/p99/p99.99/max jitter and the overrun count,
+ * first as a readable summary on stderr and then as one JSON line on stdout
+ * for regression tracking.
+ *
+ * A TICK_TICKLESS build computes the tick number from the clock and has no
+ * per-tick deadline, so the program refuses to run there. The tick thread
+ * loop is the same in both modes, so the periodic result stands for it.
+ *
+ * Build it once per backend, e.g.:
+ *   g++ -std=c++11 -O2 tickLib.cpp tickLatency.cpp -o tickLatency -pthread
+ *   g++ -std=c++11 -O2 -DUSE_TIMERFD tickLib.cpp tickLatency.cpp -o tickLatency -pthread
+ *
+ * Usage: tickLatency [-r rate] [-d seconds] [-p fifoPrio] [-c cpu] [-l loadThreads]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include "tickLib.h"
+
+#if defined(USE_TIMERFD)
+static const char* const BACKEND = "timerfd";
+#elif defined(USE_POSIX_CLOCK)
+static const char* const BACKEND = "posix_clock";
+#else
+static const char* const BACKEND = "steady_clock";
+#endif
+
+static const char* const MODE = "periodic";
+
+/* Histogram: 1 us buckets from -HIST_NEG_US to +HIST_POS_US, clamped at the ends */
+static const int HIST_NEG_US = 1000;
+static const int HIST_POS_US = 20000;
+static const int HIST_BUCKETS = HIST_NEG_US + HIST_POS_US + 1;
+
+static std::atomic<uint64_t> g_hist[HIST_BUCKETS];
+static std::atomic<uint64_t> g_samples{0};
+static std::atomic<int64_t> g_sumNs{0};
+static std::atomic<int64_t> g_minNs{INT64_MAX};
+static std::atomic<int64_t> g_maxNs{INT64_MIN};
+
+static std::atomic<bool> g_loadRunning{true};
+
+static uint64_t nowNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * @brief Tick hook: record actual minus programmed time of this tick.
+ */
+static void latencyHook(uint64_t, void*)
+{
+    uint64_t now = nowNs();
+    uint64_t due = tickAnnounceDueNs();
+    if (due == 0)
+        return;     // not announced by the tick thread
+    int64_t jitter = static_cast<int64_t>(now - due);
+
+    int64_t us = jitter / 1000;
+    if (us < -HIST_NEG_US) us = -HIST_NEG_US;
+    if (us > HIST_POS_US) us = HIST_POS_US;
+    g_hist[us + HIST_NEG_US].fetch_add(1, std::memory_order_relaxed);
+
+    g_samples.fetch_add(1, std::memory_order_relaxed);
+    g_sumNs.fetch_add(jitter, std::memory_order_relaxed);
+    int64_t m = g_minNs.load(std::memory_order_relaxed);
+    while (jitter < m && !g_minNs.compare_exchange_weak(m, jitter, std::memory_order_relaxed))
+        ;
+    m = g_maxNs.load(std::memory_order_relaxed);
+    while (jitter > m && !g_maxNs.compare_exchange_weak(m, jitter, std::memory_order_relaxed))
+        ;
+}
+
+/**
+ * @brief Jitter (us) below which the fraction @p q of all samples lies.
+ */
+static int percentileUs(uint64_t total, double q)
+{
+    uint64_t target = static_cast<uint64_t>(q * static_cast<double>(total));
+    uint64_t seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++)
+    {
+        seen += g_hist[i].load();
+        if (seen > target)
+            return i - HIST_NEG_US;
+    }
+    return HIST_POS_US;
+}
+
+static void cpuHog()
+{
+    volatile uint64_t x = 0;
+    while (g_loadRunning.load(std::memory_order_relaxed))
+        x = x + 1;
+}
+
+int main(int argc, char* argv[])
+{
+#ifdef TICK_TICKLESS
+    (void)argc;
+    fprintf(stderr, "%s: tick jitter cannot be measured in a TICK_TICKLESS build; "
+            "its ticks have no programmed deadlines\n", argv[0]);
+    return 2;
+#endif
+    int rate = 1000, seconds = 10, prio = 0, cpu = -1, load = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "r:d:p:c:l:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'r': rate = atoi(optarg); break;
+        case 'd': seconds = atoi(optarg); break;
+        case 'p': prio = atoi(optarg); break;
+        case 'c': cpu = atoi(optarg); break;
+        case 'l': load = atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-r rate] [-d seconds] [-p fifoPrio] [-c cpu] [-l loadThreads]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (rate <= 0 || seconds <= 0)
+    {
+        fprintf(stderr, "rate and duration must be positive\n");
+        return 2;
+    }
+
+    if (tickLibThreadConfig(prio, cpu) != 0)
+        fprintf(stderr, "warning: could not apply priority %d / cpu %d to the tick thread\n", prio, cpu);
+
+    std::vector<std::thread> hogs;
+    for (int i = 0; i < load; i++)
+        hogs.emplace_back(cpuHog);
+
+    uint64_t overrunsBefore = tickOverrunGet();
+    tickHookAdd(latencyHook, nullptr);
+    if (tickLibInit(rate) != 0)
+    {
+        fprintf(stderr, "tickLibInit failed\n");
+        return 1;
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+
+    tickHookDelete(latencyHook, nullptr);
+    tickLibShutdown();
+    g_loadRunning.store(false);
+    for (std::thread& t : hogs)
+        t.join();
+
+    uint64_t n = g_samples.load();
+    uint64_t overruns = tickOverrunGet() - overrunsBefore;
+    if (n == 0)
+    {
+        fprintf(stderr, "no samples collected\n");
+        return 1;
+    }
+
+    double minUs = g_minNs.load() / 1000.0;
+    double avgUs = static_cast<double>(g_sumNs.load()) / n / 1000.0;
+    double maxUs = g_maxNs.load() / 1000.0;
+    int p99 = percentileUs(n, 0.99);
+    int p9999 = percentileUs(n, 0.9999);
+
+    fprintf(stderr, "backend %s (%s), %d Hz, %d s, %d load thread(s)\n",
+            BACKEND, MODE, rate, seconds, load);
+    fprintf(stderr, "samples %llu  overruns %llu\n",
+            static_cast<unsigned long long>(n), static_cast<unsigned long long>(overruns));
+    fprintf(stderr, "jitter us: min %.1f  avg %.1f  p99 %d  p99.99 %d  max %.1f\n",
+            minUs, avgUs, p99, p9999, maxUs);
+
+    printf("{\"backend\":\"%s\",\"mode\":\"%s\",\"rate\":%d,\"seconds\":%d,"
+           "\"load\":%d,\"fifoPriority\":%d,\"cpu\":%d,\"samples\":%llu,"
+           "\"overruns\":%llu,\"minUs\":%.1f,\"avgUs\":%.1f,\"p99Us\":%d,"
+           "\"p9999Us\":%d,\"maxUs\":%.1f}\n",
+           BACKEND, MODE, rate, seconds, load, prio, cpu,
+           static_cast<unsigned long long>(n), static_cast<unsigned long long>(overruns),
+           minUs, avgUs, p99, p9999, maxUs);
+    return 0;
+}
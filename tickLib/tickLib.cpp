@@ -6,6 +6,34 @@
  * The tick counter is based on either:
  *   - std::chrono::steady_clock (default), or
  *   - POSIX clock_gettime(CLOCK_MONOTONIC)
+ *   - timerfd_create(CLOCK_MONOTONIC) with TFD_TIMER_ABSTIME (-DUSE_TIMERFD),
+ *     where the kernel's expiration count reports missed ticks exactly
+ *
+ * The tick thread sleeps until absolute CLOCK_MONOTONIC deadlines
+ * (epoch + k / rate, in nanoseconds), so rounding never accumulates into
+ * drift. Ticks that are due when the thread wakes up late are all announced
+ * and the surplus is counted as overruns.
+ *
+ * Built with -DTICK_TICKLESS there is no tick thread at all: ::tickGet
+ * derives the count on demand as base + (now - epoch) * rate from the vDSO
+ * clock, and timed services (wdLib, timeouts) arm their own deadlines.
+ *
+ * Tick hooks (::tickHookAdd) run on every tick from the tick thread. The
+ * hook list is an immutable array swapped RCU-style, so ::tickAnnounce walks
+ * it without taking a lock; writers wait for in-flight readers before
+ * freeing the old array.
+ *
+ * In virtual mode (::tickVirtualModeSet) the tick thread is stopped and
+ * time only moves when the program calls ::tickAnnounce or ::tickAdvance,
+ * so tests can fast-forward through long timeouts deterministically.
+ *
+ * One process can publish its tick domain in a shared-memory page
+ * (::tickShmPublish); processes that attach to it (::tickShmAttach) read
+ * ::tickGet and ::sysClkRateGet from the page and run no tick thread.
+ *
+ * ::tickTimestamp reads the invariant TSC (or the ARM generic timer),
+ * calibrated once against CLOCK_MONOTONIC, for cheap high-resolution
+ * stamps; elsewhere it falls back to clock_gettime in nanoseconds.
  *
  * @note This library is designed for portability and real-time OS emulation.
  */
@@ -15,50 +43,765 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <chrono>
+#include <vector>
+#include <stdio.h>
+
+#include <pthread.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #ifdef USE_POSIX_CLOCK
 #include <time.h>
 #endif
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#include <cpuid.h>
+#define TICK_TS_HW 1
+#elif defined(__aarch64__)
+#define TICK_TS_HW 1
+#endif
+
+#ifdef USE_TIMERFD
+#include <time.h>
+#include <poll.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+#endif
+
 /* ---------------------------------------------------------------------- */
 /* Internal state */
 /* ---------------------------------------------------------------------- */
 
+static const uint64_t NS_PER_SEC = 1000000000ULL;
+
 /// Global tick counter
 static std::atomic<uint64_t> g_tickCount{0};
 
 /// Tick rate (ticks per second)
 static std::atomic<uint32_t> g_ticksPerSecond{60};  ///< Default 60 Hz
 
+/// Ticks announced late by the tick thread (more than one due per wakeup)
+static std::atomic<uint64_t> g_tickOverruns{0};
+
+/// Virtual time: g_tickCount only moves through tickAnnounce/tickAdvance
+static std::atomic<bool> g_tickVirtual{false};
+
+#ifdef TICK_TICKLESS
+/// Tickless time base: tick = base + (now - epoch) * rate, guarded by a seqlock
+static std::atomic<uint32_t> g_tlSeq{0};
+static std::atomic<uint64_t> g_tlEpochNs{0};    ///< 0 until tickLibInit
+static std::atomic<uint64_t> g_tlBase{0};
+#endif
+
 /// Tick thread control
 static std::thread g_tickThread;
 static std::atomic<bool> g_tickRunning{false};
 static std::mutex g_tickMutex;
 static std::condition_variable g_tickCv;
 
+/// Tick thread scheduling: SCHED_FIFO priority (0 = default policy), CPU (-1 = any)
+static std::atomic<int> g_tickThreadPriority{0};
+static std::atomic<int> g_tickThreadCpu{-1};
+/// Scheduling the tick thread inherited, restored when the configuration
+/// goes back to the defaults (all under g_tickMutex)
+static int g_tickInheritedPolicy = SCHED_OTHER;
+static struct sched_param g_tickInheritedParam;
+static cpu_set_t g_tickInheritedCpus;
+static bool g_tickPolicySet = false;    ///< Running thread has a configured priority
+static bool g_tickCpuSet = false;       ///< Running thread is pinned to a configured CPU
+
+#ifdef USE_TIMERFD
+/// eventfd used to wake the timerfd tick thread for rate changes/shutdown
+static int g_tickWakeFd = -1;
+#endif
+
+/* ---------------------------------------------------------------------- */
+/* Internal helper: monotonic time base */
+/* ---------------------------------------------------------------------- */
+
+/**
+ * @brief Current CLOCK_MONOTONIC time in nanoseconds.
+ *
+ * libstdc++'s steady_clock reads CLOCK_MONOTONIC, so both backends share
+ * one time base and either can feed std::condition_variable::wait_until.
+ */
+static uint64_t tickNowNs()
+{
+#ifdef USE_POSIX_CLOCK
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * NS_PER_SEC + ts.tv_nsec;
+#else
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/**
+ * @brief Offset of tick @p k from the epoch, rounded up to the nanosecond.
+ *
+ * Rounding up guarantees that at the deadline of tick k at least k whole
+ * periods have elapsed; whole seconds are exact, so errors never add up.
+ */
+static inline uint64_t tickOffsetNs(uint64_t k, uint32_t tps)
+{
+    return (k / tps) * NS_PER_SEC + ((k % tps) * NS_PER_SEC + tps - 1) / tps;
+}
+
+/**
+ * @brief Whole ticks in @p ns at @p tps ticks per second (rounded down).
+ */
+static inline uint64_t tickNsToTicks(uint64_t ns, uint64_t tps)
+{
+    return (ns / NS_PER_SEC) * tps + ((ns % NS_PER_SEC) * tps) / NS_PER_SEC;
+}
+
+#ifdef TICK_TICKLESS
+/* ---------------------------------------------------------------------- */
+/* Internal helper: tickless time base */
+/* ---------------------------------------------------------------------- */
+
+/**
+ * @brief Compute the current tick from the clock (lock-free reader).
+ */
+static uint64_t ticklessNow()
+{
+    uint32_t seq;
+    uint64_t epoch, base, tps;
+    do
+    {
+        seq = g_tlSeq.load(std::memory_order_acquire);
+        epoch = g_tlEpochNs.load(std::memory_order_relaxed);
+        base = g_tlBase.load(std::memory_order_relaxed);
+        tps = g_ticksPerSecond.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((seq & 1) || g_tlSeq.load(std::memory_order_relaxed) != seq);
+
+    if (epoch == 0)
+        return base;
+    return base + tickNsToTicks(tickNowNs() - epoch, tps);
+}
+
+/**
+ * @brief Re-base the tickless time base (caller holds g_tickMutex).
+ *
+ * @param newBase Tick count at this instant.
+ * @param newTps Rate from this instant on.
+ */
+static void ticklessRebase(uint64_t newBase, uint32_t newTps)
+{
+    g_tlSeq.fetch_add(1, std::memory_order_relaxed);     // odd: update in progress
+    std::atomic_thread_fence(std::memory_order_release);
+    g_tlEpochNs.store(tickNowNs(), std::memory_order_relaxed);
+    g_tlBase.store(newBase, std::memory_order_relaxed);
+    g_ticksPerSecond.store(newTps, std::memory_order_relaxed);
+    g_tlSeq.fetch_add(1, std::memory_order_release);     // even: stable
+}
+#endif /* TICK_TICKLESS */
+
+/* ---------------------------------------------------------------------- */
+/* Internal helper: timestamp counter */
+/* ---------------------------------------------------------------------- */
+
+static const uint64_t TICK_TS_CALIBRATE_NS = 10000000ULL;  ///< 10 ms calibration window
+
+static std::once_flag g_tsOnce;
+static std::atomic<bool> g_tsReady{false};
+static bool g_tsHw = false;         ///< Counter is the TSC / generic timer
+static uint64_t g_tsFreq = NS_PER_SEC;
+static uint64_t g_tsMult = 1ULL << 32;     ///< ns = (counts * mult) >> 32
+
+/**
+ * @brief Read the hardware counter (only meaningful when g_tsHw).
+ */
+static inline uint64_t tickTsRead()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t v;
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(v));
+    return v;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Check for a counter that ticks at a constant rate on every CPU.
+ */
+static bool tickTsHwUsable()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx))
+        return false;
+    return (edx & (1U << 8)) != 0;      // invariant TSC
+#elif defined(__aarch64__)
+    return true;                        // the generic timer is architecturally constant
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Sample the counter and CLOCK_MONOTONIC as close together as possible.
+ *
+ * Of a few attempts, keeps the one whose two counter reads bracket the
+ * clock read most tightly and uses their midpoint.
+ */
+static void tickTsSample(uint64_t* counts, uint64_t* ns)
+{
+    uint64_t best = UINT64_MAX;
+    for (int i = 0; i < 5; i++)
+    {
+        uint64_t c0 = tickTsRead();
+        uint64_t t = tickNowNs();
+        uint64_t c1 = tickTsRead();
+        if (c1 - c0 < best)
+        {
+            best = c1 - c0;
+            *counts = c0 + (c1 - c0) / 2;
+            *ns = t;
+        }
+    }
+}
+
+/**
+ * @brief One-time calibration of the timestamp counter.
+ */
+static void tickTsCalibrate()
+{
+#ifdef TICK_TS_HW
+    if (tickTsHwUsable())
+    {
+        uint64_t c0 = 0, t0 = 0, c1 = 0, t1 = 0;
+        tickTsSample(&c0, &t0);
+        do
+        {
+            tickTsSample(&c1, &t1);
+        } while (t1 - t0 < TICK_TS_CALIBRATE_NS);
+
+        uint64_t freq = static_cast<uint64_t>(
+            static_cast<unsigned __int128>(c1 - c0) * NS_PER_SEC / (t1 - t0));
+        if (freq >= 1000000ULL)         // below 1 MHz something is wrong
+        {
+            g_tsFreq = freq;
+            g_tsMult = static_cast<uint64_t>((static_cast<unsigned __int128>(NS_PER_SEC) << 32) / freq);
+            g_tsHw = true;
+        }
+    }
+#endif
+    g_tsReady.store(true, std::memory_order_release);
+}
+
+static inline void tickTsInit()
+{
+    if (!g_tsReady.load(std::memory_order_acquire))
+        std::call_once(g_tsOnce, tickTsCalibrate);
+}
+
+/* ---------------------------------------------------------------------- */
+/* Internal helper: shared tick page */
+/* ---------------------------------------------------------------------- */
+
+static const uint32_t TICK_SHM_MAGIC = 0x5449434bU;    ///< "TICK"
+static const uint32_t TICK_SHM_VIRTUAL = 0x1;          ///< Owner runs virtual time
+
+/**
+ * @brief Tick page shared between processes; only the owner writes it.
+ *
+ * A periodic or virtual owner stores every tick into tickCount, so a
+ * reader's ::tickGet is a single load. A tickless owner publishes its time
+ * base instead (epochNs != 0) and readers compute the count from the
+ * system-wide CLOCK_MONOTONIC. The rarely changing fields sit under a
+ * seqlock.
+ */
+struct TickShmPage
+{
+    std::atomic<uint32_t> magic;            ///< TICK_SHM_MAGIC once initialized
+    std::atomic<uint32_t> seq;              ///< Odd while the owner updates
+    std::atomic<uint32_t> ticksPerSecond;
+    std::atomic<uint32_t> flags;            ///< TICK_SHM_VIRTUAL
+    std::atomic<uint64_t> tickCount;
+    std::atomic<uint64_t> epochNs;          ///< Tickless owner: base + (now - epoch) * rate
+    std::atomic<uint64_t> base;
+};
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+              "the tick page needs address-free 64-bit atomics");
+
+static std::atomic<TickShmPage*> g_shmOwned{nullptr};      ///< Page this process publishes
+static std::atomic<TickShmPage*> g_shmAttached{nullptr};   ///< Page this process reads
+
+/**
+ * @brief Publish a new tick count (per-tick fast path of the owner).
+ */
+static inline void tickShmCount(uint64_t tick)
+{
+    TickShmPage* page = g_shmOwned.load(std::memory_order_relaxed);
+    if (page)
+        page->tickCount.store(tick, std::memory_order_release);
+}
+
+/**
+ * @brief Copy the whole local time base into the owned page.
+ *
+ * Called after rate, mode or base changes (caller holds g_tickMutex).
+ */
+static void tickShmSync()
+{
+    TickShmPage* page = g_shmOwned.load();
+    if (!page)
+        return;
+
+    bool virt = g_tickVirtual.load();
+    uint64_t epoch = 0, base = 0, count = g_tickCount.load();
+#ifdef TICK_TICKLESS
+    if (!virt)
+    {
+        epoch = g_tlEpochNs.load();
+        base = g_tlBase.load();
+        count = base;
+    }
+#endif
+
+    page->seq.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    page->ticksPerSecond.store(g_ticksPerSecond.load(), std::memory_order_relaxed);
+    page->flags.store(virt ? TICK_SHM_VIRTUAL : 0, std::memory_order_relaxed);
+    page->epochNs.store(epoch, std::memory_order_relaxed);
+    page->base.store(base, std::memory_order_relaxed);
+    page->tickCount.store(count, std::memory_order_relaxed);
+    page->seq.fetch_add(1, std::memory_order_release);
+}
+
+/**
+ * @brief Current tick of an attached page.
+ */
+static uint64_t tickShmRead(const TickShmPage* page)
+{
+    uint32_t seq;
+    uint64_t epoch, base, tps;
+    do
+    {
+        seq = page->seq.load(std::memory_order_acquire);
+        epoch = page->epochNs.load(std::memory_order_relaxed);
+        base = page->base.load(std::memory_order_relaxed);
+        tps = page->ticksPerSecond.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((seq & 1) || page->seq.load(std::memory_order_relaxed) != seq);
+
+    if (epoch == 0)
+        return page->tickCount.load(std::memory_order_acquire);
+    return base + tickNsToTicks(tickNowNs() - epoch, tps);
+}
+
+/**
+ * @brief Tick rate of the domain this process lives in.
+ */
+static inline uint64_t tickRate()
+{
+    TickShmPage* page = g_shmAttached.load(std::memory_order_relaxed);
+    if (page)
+        return page->ticksPerSecond.load(std::memory_order_relaxed);
+    return g_ticksPerSecond.load();
+}
+
+/**
+ * @brief Build the shm_open name ("/name") for a tick page.
+ */
+static int tickShmName(const char* name, char* buf, size_t size)
+{
+    if (!name || !*name)
+        return -1;
+    int n = snprintf(buf, size, "%s%s", name[0] == '/' ? "" : "/", name);
+    return (n > 0 && static_cast<size_t>(n) < size) ? 0 : -1;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Internal helper: tick hooks */
+/* ---------------------------------------------------------------------- */
+
+/// One registered hook with its run-time accounting
+struct TickHookEntry
+{
+    TICK_HOOK fn;
+    void* arg;
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> totalNs{0};
+    std::atomic<uint64_t> maxNs{0};
+};
+
+/// Immutable snapshot of the hook list, replaced as a whole by writers
+struct TickHookTable
+{
+    std::vector<TickHookEntry*> hooks;
+};
+
+static std::atomic<TickHookTable*> g_hookTable{nullptr};
+static std::atomic<uint32_t> g_hookReaders{0};  ///< Threads inside tickHooksRun
+static std::mutex g_hookMutex;                  ///< Serializes writers
+static std::vector<TickHookTable*> g_hookRetiredTables;
+static std::vector<TickHookEntry*> g_hookRetiredEntries;
+static thread_local bool t_inHook = false;
+
+/**
+ * @brief Run all hooks for @p tick (lock-free reader side).
+ */
+static void tickHooksRun(uint64_t tick)
+{
+    if (!g_hookTable.load(std::memory_order_relaxed))
+        return;
+
+    g_hookReaders.fetch_add(1);
+    TickHookTable* table = g_hookTable.load();
+    if (table)
+    {
+        t_inHook = true;
+        uint64_t t0 = tickNowNs();
+        for (TickHookEntry* h : table->hooks)
+        {
+            h->fn(tick, h->arg);
+            uint64_t t1 = tickNowNs();
+            uint64_t ns = t1 - t0;
+            h->calls.fetch_add(1, std::memory_order_relaxed);
+            h->totalNs.fetch_add(ns, std::memory_order_relaxed);
+            // tickAnnounce may run from several threads; never lose a larger max
+            uint64_t m = h->maxNs.load(std::memory_order_relaxed);
+            while (ns > m && !h->maxNs.compare_exchange_weak(m, ns, std::memory_order_relaxed))
+                ;
+            t0 = t1;
+        }
+        t_inHook = false;
+    }
+    g_hookReaders.fetch_sub(1);
+}
+
+/**
+ * @brief Publish a new hook table and reclaim what readers no longer see.
+ *
+ * Called with @p lock on g_hookMutex held; returns with it released. The
+ * wait for running hooks happens after the unlock, because one of them may
+ * be blocked on g_hookMutex in tickHookAdd/Delete. When called from inside
+ * a hook the grace period cannot complete, so the old data stays retired
+ * and is freed by a later writer.
+ */
+static void tickHooksPublish(std::unique_lock<std::mutex>& lock, TickHookTable* table,
+                             TickHookEntry* removed)
+{
+    TickHookTable* old = g_hookTable.exchange(table);
+    if (old)
+        g_hookRetiredTables.push_back(old);
+    if (removed)
+        g_hookRetiredEntries.push_back(removed);
+    if (t_inHook)
+    {
+        lock.unlock();
+        return;
+    }
+
+    // all of these are unpublished by now; later writers retire their own
+    std::vector<TickHookTable*> tables;
+    std::vector<TickHookEntry*> entries;
+    tables.swap(g_hookRetiredTables);
+    entries.swap(g_hookRetiredEntries);
+    lock.unlock();
+
+    while (g_hookReaders.load() != 0)
+        std::this_thread::yield();
+
+    for (TickHookTable* t : tables)
+        delete t;
+    for (TickHookEntry* h : entries)
+        delete h;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Internal helper: tick thread plumbing */
+/* ---------------------------------------------------------------------- */
+
+/**
+ * @brief Apply the configured policy, priority and CPU affinity to the
+ *        tick thread (caller holds g_tickMutex).
+ *
+ * Defaults leave the inherited scheduling alone, so a `taskset` or `chrt`
+ * on the process still applies; going back to the defaults restores what
+ * the thread inherited.
+ *
+ * @return 0 on success, -1 if the system refused (e.g. no CAP_SYS_NICE).
+ */
+static int tickThreadApplyConfig(pthread_t thread)
+{
+    int status = 0;
+    int prio = g_tickThreadPriority.load();
+    int cpu = g_tickThreadCpu.load();
+
+    if (prio > 0)
+    {
+        struct sched_param param = {};
+        param.sched_priority = prio;
+        if (pthread_setschedparam(thread, SCHED_FIFO, &param) != 0)
+            status = -1;
+        else
+            g_tickPolicySet = true;
+    }
+    else if (g_tickPolicySet)
+    {
+        if (pthread_setschedparam(thread, g_tickInheritedPolicy, &g_tickInheritedParam) != 0)
+            status = -1;
+        else
+            g_tickPolicySet = false;
+    }
+
+    if (cpu >= 0)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (pthread_setaffinity_np(thread, sizeof(set), &set) != 0)
+            status = -1;
+        else
+            g_tickCpuSet = true;
+    }
+    else if (g_tickCpuSet)
+    {
+        if (pthread_setaffinity_np(thread, sizeof(g_tickInheritedCpus), &g_tickInheritedCpus) != 0)
+            status = -1;
+        else
+            g_tickCpuSet = false;
+    }
+    return status;
+}
+
+#ifdef TICK_TICKLESS
+static uint64_t g_tlHooked = 0;     ///< Last tick given to the hooks (tick thread only)
+#endif
+
+/// Deadline of the tick the tick thread is announcing, 0 elsewhere
+static thread_local uint64_t t_tickDueNs = 0;
+
+/**
+ * @brief Deadline of tick @p k since @p epoch, as the backend programmed it.
+ */
+static inline uint64_t tickDueNs(uint64_t epoch, uint64_t k, uint32_t tps)
+{
+#ifdef USE_TIMERFD
+    // the kernel steps the truncated interval from the first expiry
+    return epoch + tickOffsetNs(1, tps) + (k - 1) * (NS_PER_SEC / tps);
+#else
+    return epoch + tickOffsetNs(k, tps);
+#endif
+}
+
+/**
+ * @brief Work of the tick thread for @p n ticks that fell due together,
+ *        ticks @p k + 1 to @p k + n since @p epoch.
+ */
+static inline void tickThreadAnnounce(uint64_t n, uint64_t epoch, uint64_t k, uint32_t tps)
+{
+#ifdef TICK_TICKLESS
+    (void)epoch;
+    (void)k;
+    (void)tps;
+    // The count itself is computed; give the hooks every tick number since
+    // the last call, once each and in order, even after a late wakeup
+    uint64_t now = ticklessNow();
+    uint64_t tick = g_tlHooked + 1;
+    if (g_tlHooked == 0 || now < g_tlHooked || now - g_tlHooked > n + 1)
+        tick = now >= n ? now - n + 1 : 0;     // first call, or the count was moved
+    for (; tick <= now; tick++)
+        tickHooksRun(tick);
+    g_tlHooked = now;
+#else
+    for (uint64_t i = 1; i <= n; i++)
+    {
+        t_tickDueNs = tickDueNs(epoch, k + i, tps);
+        tickAnnounce();
+    }
+    t_tickDueNs = 0;
+#endif
+}
+
+/**
+ * @brief Wake the tick thread to re-read the rate or stop.
+ */
+static void tickThreadWake()
+{
+    g_tickCv.notify_all();
+#ifdef USE_TIMERFD
+    if (g_tickWakeFd >= 0)
+    {
+        uint64_t one = 1;
+        ssize_t rc = write(g_tickWakeFd, &one, sizeof(one));
+        (void)rc;
+    }
+#endif
+}
+
 /* ---------------------------------------------------------------------- */
 /* Internal helper: sleep per tick */
 /* ---------------------------------------------------------------------- */
 
+#ifndef USE_TIMERFD
 static void tickSleepLoop()
 {
     using namespace std::chrono;
 
     uint32_t tps = g_ticksPerSecond.load();
-    auto tickDuration = duration<double>(1.0 / static_cast<double>(tps));
+    uint64_t epoch = tickNowNs();   // deadline of tick k is epoch + k/tps
+    uint64_t k = 0;                 // ticks announced since epoch
 
+    std::unique_lock<std::mutex> lock(g_tickMutex);
     while (g_tickRunning.load())
     {
+        uint32_t newTps = g_ticksPerSecond.load();
+        if (newTps != tps)
+        {
+            // Re-base on the last deadline that was honoured
+            epoch += tickOffsetNs(k, tps);
+            k = 0;
+            tps = newTps;
+        }
+        else if (k >= tps)
         {
-            std::unique_lock<std::mutex> lock(g_tickMutex);
-            g_tickCv.wait_for(lock, duration_cast<milliseconds>(tickDuration),
-                              [] { return !g_tickRunning.load(); });
+            // Keep k small: whole seconds fold into the epoch exactly
+            epoch += (k / tps) * NS_PER_SEC;
+            k %= tps;
         }
 
+        uint64_t deadline = epoch + tickOffsetNs(k + 1, tps);
+        g_tickCv.wait_until(lock, steady_clock::time_point(nanoseconds(deadline)),
+                            [tps] { return !g_tickRunning.load()
+                                           || g_ticksPerSecond.load() != tps; });
+
         if (!g_tickRunning.load())
             break;
 
-        tickAnnounce();
+        uint64_t now = tickNowNs();
+        if (now < deadline)
+            continue;   // woken for a rate change
+
+        // Announce every tick that is due; more than one is an overrun
+        uint64_t due = tickNsToTicks(now - epoch, tps);
+        uint64_t missed = due - k - 1;
+
+        lock.unlock();
+        if (missed)
+            g_tickOverruns.fetch_add(missed);
+        tickThreadAnnounce(due - k, epoch, k, tps);
+        k = due;
+        lock.lock();
+    }
+}
+#else /* USE_TIMERFD */
+
+/**
+ * @brief Arm @p fd periodically, first expiry at absolute time @p firstNs.
+ *
+ * The interval is rounded down to whole nanoseconds; the caller re-arms on
+ * every whole second so that rounding cannot accumulate.
+ */
+static void tickTimerfdArm(int fd, uint64_t firstNs, uint32_t tps)
+{
+    struct itimerspec its = {};
+    its.it_value.tv_sec = static_cast<time_t>(firstNs / NS_PER_SEC);
+    its.it_value.tv_nsec = static_cast<long>(firstNs % NS_PER_SEC);
+    its.it_interval.tv_nsec = static_cast<long>(NS_PER_SEC / tps);
+    if (tps == 1)
+    {
+        its.it_interval.tv_sec = 1;
+        its.it_interval.tv_nsec = 0;
+    }
+    timerfd_settime(fd, TFD_TIMER_ABSTIME, &its, nullptr);
+}
+
+static void tickSleepLoop()
+{
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (fd < 0)
+    {
+        g_tickRunning.store(false);
+        return;
+    }
+
+    uint32_t tps = g_ticksPerSecond.load();
+    uint64_t epoch;                 // deadline of tick k is epoch + k/tps
+    uint64_t k = 0;                 // ticks announced since epoch
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        epoch = static_cast<uint64_t>(ts.tv_sec) * NS_PER_SEC + ts.tv_nsec;
+    }
+    tickTimerfdArm(fd, epoch + tickOffsetNs(1, tps), tps);
+
+    struct pollfd pfd[2] = { { fd, POLLIN, 0 }, { g_tickWakeFd, POLLIN, 0 } };
+    while (g_tickRunning.load())
+    {
+        if (poll(pfd, 2, -1) < 0)
+            continue;
+
+        if (pfd[1].revents & POLLIN)
+        {
+            uint64_t dummy;
+            ssize_t rc = read(g_tickWakeFd, &dummy, sizeof(dummy));
+            (void)rc;
+        }
+        if (!g_tickRunning.load())
+            break;
+
+        uint64_t expirations = 0;
+        if ((pfd[0].revents & POLLIN)
+            && read(fd, &expirations, sizeof(expirations)) == sizeof(expirations)
+            && expirations > 0)
+        {
+            // The kernel counted every period that elapsed since the last read
+            if (expirations > 1)
+                g_tickOverruns.fetch_add(expirations - 1);
+            tickThreadAnnounce(expirations, epoch, k, tps);
+            k += expirations;
+        }
+
+        uint32_t newTps = g_ticksPerSecond.load();
+        if (newTps != tps || k >= tps)
+        {
+            // Re-base on the last honoured deadline and re-arm exactly
+            epoch += tickOffsetNs(k, tps);
+            k = 0;
+            tps = newTps;
+            tickTimerfdArm(fd, epoch + tickOffsetNs(1, tps), tps);
+        }
+    }
+    close(fd);
+}
+#endif /* USE_TIMERFD */
+
+/**
+ * @brief Start the tick thread if it is not running (caller holds g_tickMutex).
+ */
+static void tickThreadStart()
+{
+    if (!g_tickRunning.load())
+    {
+        if (g_tickThread.joinable())
+            g_tickThread.join();    // a previous thread that already stopped
+        g_tickRunning.store(true);
+#ifdef USE_TIMERFD
+        if (g_tickWakeFd < 0)
+            g_tickWakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+#endif
+        // The new thread inherits the caller's scheduling; remember it
+        pthread_getschedparam(pthread_self(), &g_tickInheritedPolicy, &g_tickInheritedParam);
+        pthread_getaffinity_np(pthread_self(), sizeof(g_tickInheritedCpus), &g_tickInheritedCpus);
+        g_tickPolicySet = false;
+        g_tickCpuSet = false;
+        g_tickThread = std::thread(tickSleepLoop);
+        tickThreadApplyConfig(g_tickThread.native_handle());
     }
 }
 
@@ -71,35 +814,64 @@ extern "C" {
 /**
  * @brief Initialize tick library.
  */
-STATUS tickLibInit(uint32_t ticksPerSecond)
+int tickLibInit(int ticksPerSecond)
 {
-    if (ticksPerSecond == 0)
-        return ERROR;
+    if (ticksPerSecond <= 0)
+        return -1;
 
-    g_ticksPerSecond.store(ticksPerSecond);
-
-    if (!g_tickRunning.load())
+    std::lock_guard<std::mutex> lock(g_tickMutex);
+    if (g_shmAttached.load())
+        return 0;   // the page owner keeps time and sets the rate
+    if (g_tickVirtual.load())
     {
-        g_tickRunning.store(true);
-        g_tickThread = std::thread(tickSleepLoop);
+        g_ticksPerSecond.store(static_cast<uint32_t>(ticksPerSecond));
+        tickShmSync();
+        return 0;   // time is driven by tickAdvance, no thread
     }
+#ifdef TICK_TICKLESS
+    ticklessRebase(ticklessNow(), static_cast<uint32_t>(ticksPerSecond));
+    // Hooks need periodic calls; without any the process stays tick-free
+    if (g_hookTable.load())
+        tickThreadStart();
+#else
+    g_ticksPerSecond.store(static_cast<uint32_t>(ticksPerSecond));
+    tickThreadStart();
+#endif
+    tickShmSync();
 
-    return OK;
+    return 0;
 }
 
 /**
  * @brief Shutdown tick library.
  */
-STATUS tickLibShutdown()
+int tickLibShutdown(void)
 {
-    if (g_tickRunning.load())
     {
+        std::lock_guard<std::mutex> lock(g_tickMutex);
         g_tickRunning.store(false);
-        g_tickCv.notify_all();
-        if (g_tickThread.joinable())
-            g_tickThread.join();
     }
-    return OK;
+    tickThreadWake();
+    if (g_tickThread.joinable())
+        g_tickThread.join();
+    return 0;
+}
+
+/**
+ * @brief Configure scheduling of the tick thread.
+ */
+int tickLibThreadConfig(int fifoPriority, int cpu)
+{
+    if (fifoPriority < 0 || fifoPriority > sched_get_priority_max(SCHED_FIFO)
+        || cpu < -1 || cpu >= CPU_SETSIZE)
+        return -1;
+
+    std::lock_guard<std::mutex> lock(g_tickMutex);
+    g_tickThreadPriority.store(fifoPriority);
+    g_tickThreadCpu.store(cpu);
+    if (g_tickRunning.load() && g_tickThread.joinable())
+        return tickThreadApplyConfig(g_tickThread.native_handle());
+    return 0;
 }
 
 /**
@@ -107,65 +879,481 @@ STATUS tickLibShutdown()
  */
 void tickAnnounce(void)
 {
-    g_tickCount.fetch_add(1);
+    if (g_shmAttached.load(std::memory_order_relaxed))
+        return;
+#ifdef TICK_TICKLESS
+    if (!g_tickVirtual.load())
+    {
+        std::lock_guard<std::mutex> lock(g_tickMutex);
+        ticklessRebase(ticklessNow() + 1, g_ticksPerSecond.load());
+        tickShmSync();
+        return;
+    }
+#endif
+    uint64_t tick = g_tickCount.fetch_add(1) + 1;
+    tickShmCount(tick);
+    tickHooksRun(tick);
+}
+
+/**
+ * @brief Deadline of the tick the calling tick hook was run for.
+ */
+uint64_t tickAnnounceDueNs(void)
+{
+    return t_tickDueNs;
+}
+
+/**
+ * @brief Advance virtual time by @p nTicks ticks.
+ */
+int tickAdvance(uint64_t nTicks)
+{
+    if (!g_tickVirtual.load())
+        return -1;
+
+    // Without hooks nobody observes the intermediate ticks
+    if (!g_hookTable.load())
+    {
+        tickShmCount(g_tickCount.fetch_add(nTicks) + nTicks);
+        return 0;
+    }
+    for (uint64_t i = 0; i < nTicks; i++)
+    {
+        uint64_t tick = g_tickCount.fetch_add(1) + 1;
+        tickShmCount(tick);
+        tickHooksRun(tick);
+    }
+    return 0;
+}
+
+/**
+ * @brief Enter or leave virtual time mode.
+ */
+int tickVirtualModeSet(int enable)
+{
+    bool on = (enable != 0);
+    if (g_shmAttached.load())
+        return -1;  // time belongs to the page owner
+    if (on)
+        tickLibShutdown();      // the tick thread must not move virtual time
+
+    std::lock_guard<std::mutex> lock(g_tickMutex);
+    if (g_tickVirtual.load() == on)
+        return 0;
+#ifdef TICK_TICKLESS
+    // Hand the count over between the clock-derived and the manual time base
+    if (on)
+        g_tickCount.store(ticklessNow());
+    else if (g_tlEpochNs.load() != 0)
+        ticklessRebase(g_tickCount.load(), g_ticksPerSecond.load());
+    else
+        g_tlBase.store(g_tickCount.load());
+#endif
+    g_tickVirtual.store(on);
+    tickShmSync();
+    return 0;
+}
+
+/**
+ * @brief Check whether virtual time mode is active.
+ */
+int tickVirtualModeGet(void)
+{
+    TickShmPage* page = g_shmAttached.load(std::memory_order_relaxed);
+    if (page)
+        return (page->flags.load(std::memory_order_relaxed) & TICK_SHM_VIRTUAL) ? 1 : 0;
+    return g_tickVirtual.load() ? 1 : 0;
 }
 
 /**
  * @brief Get current tick count.
  */
-UINT32 tickGet(void)
+uint64_t tickGet(void)
 {
-    return static_cast<UINT32>(g_tickCount.load());
+    TickShmPage* page = g_shmAttached.load(std::memory_order_relaxed);
+    if (page)
+        return tickShmRead(page);
+#ifdef TICK_TICKLESS
+    if (!g_tickVirtual.load())
+        return ticklessNow();
+#endif
+    return g_tickCount.load();
 }
 
 /**
  * @brief Set tick counter.
  */
-void tickSet(UINT32 newTick)
+void tickSet(uint64_t newTick)
 {
+    std::lock_guard<std::mutex> lock(g_tickMutex);
+    if (g_shmAttached.load())
+        return;
+#ifdef TICK_TICKLESS
+    if (!g_tickVirtual.load())
+    {
+        ticklessRebase(newTick, g_ticksPerSecond.load());
+        tickShmSync();
+        return;
+    }
+#endif
     g_tickCount.store(newTick);
+    tickShmSync();
+}
+
+/**
+ * @brief Get number of ticks the tick thread announced late.
+ */
+uint64_t tickOverrunGet(void)
+{
+    return g_tickOverruns.load();
 }
 
 /**
  * @brief Get ticks per second.
  */
-UINT32 sysClkRateGet(void)
+int sysClkRateGet(void)
 {
-    return g_ticksPerSecond.load();
+    return static_cast<int>(tickRate());
 }
 
 /**
  * @brief Set ticks per second (changes tick thread rate).
  */
-STATUS sysClkRateSet(UINT32 ticksPerSecond)
+int sysClkRateSet(int ticksPerSecond)
+{
+    if (ticksPerSecond <= 0)
+        return -1;
+
+    {
+        std::lock_guard<std::mutex> lock(g_tickMutex);
+        if (g_shmAttached.load())
+            return -1;  // only the page owner sets the rate
+#ifdef TICK_TICKLESS
+        if (!g_tickVirtual.load() && g_tlEpochNs.load() != 0)
+        {
+            ticklessRebase(ticklessNow(), static_cast<uint32_t>(ticksPerSecond));
+            tickShmSync();
+            return 0;
+        }
+#endif
+        g_ticksPerSecond.store(static_cast<uint32_t>(ticksPerSecond));
+        tickShmSync();
+    }
+    tickThreadWake();  // wake tick thread to recompute rate
+    return 0;
+}
+
+/**
+ * @brief Convert ticks to milliseconds (rounded down).
+ */
+uint64_t tickToMs(uint64_t ticks)
 {
-    if (ticksPerSecond == 0)
-        return ERROR;
+    uint64_t tps = tickRate();
+    return (ticks / tps) * 1000ULL + ((ticks % tps) * 1000ULL) / tps;
+}
 
-    g_ticksPerSecond.store(ticksPerSecond);
-    g_tickCv.notify_all();  // wake tick thread to recompute rate
-    return OK;
+/**
+ * @brief Convert milliseconds to ticks (rounded up, so delays are never short).
+ */
+uint64_t msToTicks(uint64_t ms)
+{
+    uint64_t tps = tickRate();
+    return (ms / 1000ULL) * tps + ((ms % 1000ULL) * tps + 999ULL) / 1000ULL;
 }
 
 /**
  * @brief Get elapsed time (in ticks) since system start.
  */
-UINT32 tickSinceBoot(void)
+uint64_t tickSinceBoot(void)
 {
+    if (g_tickVirtual.load() || g_shmAttached.load())
+        return tickGet();
+
+    uint64_t tps = g_ticksPerSecond.load();
 #ifdef USE_POSIX_CLOCK
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    uint64_t ns = static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
-    uint64_t ticks = ns / (1000000000ULL / g_ticksPerSecond.load());
-    return static_cast<UINT32>(ticks);
+    uint64_t ns = tickNowNs();
 #else
     using namespace std::chrono;
     static steady_clock::time_point start = steady_clock::now();
-    auto elapsed = steady_clock::now() - start;
-    uint64_t ticks = duration_cast<nanoseconds>(elapsed).count()
-                     / (1000000000ULL / g_ticksPerSecond.load());
-    return static_cast<UINT32>(ticks);
+    uint64_t ns = duration_cast<nanoseconds>(steady_clock::now() - start).count();
 #endif
+    return tickNsToTicks(ns, tps);
+}
+
+/**
+ * @brief Register a hook called on every tick.
+ */
+int tickHookAdd(TICK_HOOK hook, void* arg)
+{
+    if (!hook)
+        return -1;
+
+    std::unique_lock<std::mutex> lock(g_hookMutex);
+    TickHookTable* old = g_hookTable.load();
+    TickHookTable* table = new TickHookTable;
+    if (old)
+        table->hooks = old->hooks;
+    TickHookEntry* entry = new TickHookEntry;
+    entry->fn = hook;
+    entry->arg = arg;
+    table->hooks.push_back(entry);
+    tickHooksPublish(lock, table, nullptr);
+
+#ifdef TICK_TICKLESS
+    std::lock_guard<std::mutex> tickLock(g_tickMutex);
+    if (g_tlEpochNs.load() != 0 && !g_tickVirtual.load())
+        tickThreadStart();
+#endif
+    return 0;
+}
+
+/**
+ * @brief Remove the first hook registered with @p hook and @p arg.
+ */
+int tickHookDelete(TICK_HOOK hook, void* arg)
+{
+    std::unique_lock<std::mutex> lock(g_hookMutex);
+    TickHookTable* old = g_hookTable.load();
+    if (!old)
+        return -1;
+
+    TickHookEntry* removed = nullptr;
+    TickHookTable* table = new TickHookTable;
+    for (TickHookEntry* h : old->hooks)
+    {
+        if (!removed && h->fn == hook && h->arg == arg)
+            removed = h;
+        else
+            table->hooks.push_back(h);
+    }
+    if (!removed)
+    {
+        delete table;
+        return -1;
+    }
+    if (table->hooks.empty())
+    {
+        delete table;
+        table = nullptr;
+    }
+    tickHooksPublish(lock, table, removed);
+    return 0;
+}
+
+/**
+ * @brief Get run-time statistics of a registered hook.
+ */
+int tickHookStatsGet(TICK_HOOK hook, void* arg, TICK_HOOK_STATS* pStats)
+{
+    if (!pStats)
+        return -1;
+
+    std::lock_guard<std::mutex> lock(g_hookMutex);
+    TickHookTable* table = g_hookTable.load();
+    if (table)
+    {
+        for (TickHookEntry* h : table->hooks)
+        {
+            if (h->fn == hook && h->arg == arg)
+            {
+                pStats->calls = h->calls.load();
+                pStats->totalNs = h->totalNs.load();
+                pStats->maxNs = h->maxNs.load();
+                return 0;
+            }
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Print all hooks with their run times.
+ */
+void tickHookShow(void)
+{
+    std::lock_guard<std::mutex> lock(g_hookMutex);
+    TickHookTable* table = g_hookTable.load();
+    uint64_t periodNs = NS_PER_SEC / g_ticksPerSecond.load();
+
+    printf("%-18s %-18s %12s %10s %10s\n", "hook", "arg", "calls", "avg ns", "max ns");
+    if (!table)
+        return;
+    for (TickHookEntry* h : table->hooks)
+    {
+        uint64_t calls = h->calls.load();
+        uint64_t maxNs = h->maxNs.load();
+        printf("%-18p %-18p %12llu %10llu %10llu%s\n",
+               reinterpret_cast<void*>(h->fn), h->arg,
+               static_cast<unsigned long long>(calls),
+               static_cast<unsigned long long>(calls ? h->totalNs.load() / calls : 0),
+               static_cast<unsigned long long>(maxNs),
+               maxNs > periodNs / 10 ? "  SLOW" : "");
+    }
+}
+
+/**
+ * @brief Publish this process's tick domain in a shared-memory page.
+ */
+int tickShmPublish(const char* name)
+{
+    char shmName[256];
+    if (tickShmName(name, shmName, sizeof(shmName)) != 0)
+        return -1;
+    if (g_shmOwned.load() || g_shmAttached.load())
+        return -1;
+
+    // Readers only get read access; an existing page (previous owner) is reused
+    int fd = shm_open(shmName, O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+        return -1;
+    size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+        return -1;
+
+    TickShmPage* page = static_cast<TickShmPage*>(addr);
+    std::lock_guard<std::mutex> lock(g_tickMutex);
+    page->seq.store(0);
+    g_shmOwned.store(page);
+    tickShmSync();
+    page->magic.store(TICK_SHM_MAGIC, std::memory_order_release);
+    return 0;
+}
+
+/**
+ * @brief Take tickGet/sysClkRateGet from a page published by another process.
+ */
+int tickShmAttach(const char* name)
+{
+    char shmName[256];
+    if (tickShmName(name, shmName, sizeof(shmName)) != 0)
+        return -1;
+    if (g_shmOwned.load() || g_shmAttached.load())
+        return -1;
+
+    int fd = shm_open(shmName, O_RDONLY, 0);
+    if (fd < 0)
+        return -1;
+
+    // Wait (up to ~1 s) for the owner to size the page
+    size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    struct stat st;
+    int tries = 0;
+    while (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) < size && ++tries < 1000)
+        usleep(1000);
+    if (static_cast<size_t>(st.st_size) < size)
+    {
+        close(fd);
+        return -1;
+    }
+    void* addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+        return -1;
+
+    // ...and to initialize it
+    TickShmPage* page = static_cast<TickShmPage*>(addr);
+    for (tries = 0; page->magic.load(std::memory_order_acquire) != TICK_SHM_MAGIC; tries++)
+    {
+        if (tries >= 1000)
+        {
+            munmap(addr, size);
+            return -1;
+        }
+        usleep(1000);
+    }
+
+    tickLibShutdown();      // the local tick thread is no longer needed
+    g_shmAttached.store(page);
+    return 0;
+}
+
+/**
+ * @brief Stop publishing or reading the shared tick page.
+ */
+int tickShmDetach(void)
+{
+    std::lock_guard<std::mutex> lock(g_tickMutex);
+    TickShmPage* owned = g_shmOwned.exchange(nullptr);
+    TickShmPage* attached = g_shmAttached.exchange(nullptr);
+    if (!owned && !attached)
+        return -1;
+    if (attached)
+    {
+        // Continue the local count where the shared domain left off
+        uint64_t now = tickShmRead(attached);
+#ifdef TICK_TICKLESS
+        ticklessRebase(now, attached->ticksPerSecond.load());
+#else
+        g_ticksPerSecond.store(attached->ticksPerSecond.load());
+#endif
+        g_tickCount.store(now);
+    }
+    // The page stays mapped: other threads may still be reading it
+    return 0;
+}
+
+/**
+ * @brief Remove the name of a shared tick page.
+ */
+int tickShmUnlink(const char* name)
+{
+    char shmName[256];
+    if (tickShmName(name, shmName, sizeof(shmName)) != 0)
+        return -1;
+    return shm_unlink(shmName) == 0 ? 0 : -1;
+}
+
+/**
+ * @brief Calibrate the timestamp counter now.
+ */
+int tickTimestampInit(void)
+{
+    tickTsInit();
+    return g_tsHw ? 0 : -1;
+}
+
+/**
+ * @brief Read the high-resolution timestamp counter.
+ */
+uint64_t tickTimestamp(void)
+{
+    tickTsInit();
+    if (g_tsHw)
+        return tickTsRead();
+    return tickNowNs();
+}
+
+/**
+ * @brief Get the timestamp counter frequency.
+ */
+uint64_t tickTimestampFreq(void)
+{
+    tickTsInit();
+    return g_tsFreq;
+}
+
+/**
+ * @brief Convert timestamp counts to nanoseconds.
+ */
+uint64_t tickTimestampToNs(uint64_t counts)
+{
+    tickTsInit();
+    return static_cast<uint64_t>((static_cast<unsigned __int128>(counts) * g_tsMult) >> 32);
+}
+
+/**
+ * @brief Convert timestamp counts to ticks at the current rate.
+ */
+uint64_t tickTimestampToTicks(uint64_t counts)
+{
+    return tickNsToTicks(tickTimestampToNs(counts), tickRate());
 }
 
 } // extern "C"
@@ -9,6 +9,20 @@
  * - C++ std::chrono::steady_clock
  * - POSIX clock_gettime(CLOCK_MONOTONIC)
  *
+ * With -DUSE_TIMERFD the tick thread is driven by a CLOCK_MONOTONIC
+ * timerfd armed with TFD_TIMER_ABSTIME instead of a condition variable.
+ *
+ * Either can be built tickless (-DTICK_TICKLESS): no tick thread runs and
+ * ::tickGet computes the count from the monotonic clock on demand.
+ *
+ * At run time the library can be switched to virtual time
+ * (::tickVirtualModeSet), where ticks only advance through ::tickAnnounce
+ * and ::tickAdvance; timeouts in semLib, msgQLib, mboxLib and wdLib then
+ * expire against the virtual count.
+ *
+ * ::tickShmPublish and ::tickShmAttach let one process own the tick count
+ * and many others read it from a shared-memory page without a tick thread.
+ *
  * The implementation in tickLib.cpp will select the backend.
  */
 
@@ -36,6 +50,88 @@ extern "C" {
  */
 int tickLibInit (int ticksPerSec);
 
+/**
+ * @brief Stop the tick thread started by tickLibInit().
+ *
+ * @return 0 on success.
+ */
+int tickLibShutdown (void);
+
+/**
+ * @brief Configure scheduling of the tick thread.
+ *
+ * May be called before or after ::tickLibInit; a running tick thread is
+ * updated immediately. Real-time priorities need CAP_SYS_NICE.
+ *
+ * @param fifoPriority SCHED_FIFO priority (1-99), or 0 to keep the policy
+ *        the thread inherited from the process.
+ * @param cpu CPU to pin the tick thread to (ideally an isolated one), or -1
+ *        to keep the inherited affinity.
+ * @return 0 on success, -1 on invalid arguments or if the system refused.
+ */
+int tickLibThreadConfig (int fifoPriority, int cpu);
+
+/**
+ * @brief Announce one system tick.
+ *
+ * Called by the tick thread for every tick period; equivalent to
+ * VxWorks ::tickAnnounce.
+ */
+void tickAnnounce (void);
+
+/**
+ * @brief Deadline of the tick being announced, for tick hooks.
+ *
+ * From a hook run by the tick thread, returns the CLOCK_MONOTONIC time (ns)
+ * at which the backend programmed that tick to fall due: epoch + n / rate,
+ * with the timerfd backend's interval rounding. Hook start minus this value
+ * is the tick's latency. Returns 0 anywhere else, for ticks announced with
+ * ::tickAnnounce or ::tickAdvance, and in TICK_TICKLESS builds.
+ */
+uint64_t tickAnnounceDueNs (void);
+
+/**
+ * @brief Real-time slice (ms) after which timed takes of shared semaphores
+ *        re-check the tick count in virtual time mode.
+ *
+ * Another process can give a shared semaphore without waking the waiter;
+ * all other timed waits are woken by the tick that expires them.
+ */
+#define TICK_VIRTUAL_POLL_MS 1
+
+/**
+ * @brief Enter or leave virtual time mode.
+ *
+ * Entering stops the tick thread; from then on ::tickGet only moves when
+ * the program calls ::tickAnnounce or ::tickAdvance, so a test can skip
+ * over minutes of timeouts in microseconds. Leaving continues from the
+ * virtual count; call ::tickLibInit again to restart the tick thread.
+ *
+ * @param enable Non-zero for virtual time, 0 for real time.
+ * @return 0 on success.
+ */
+int tickVirtualModeSet (int enable);
+
+/**
+ * @brief Check whether virtual time mode is active.
+ *
+ * @return 1 in virtual time mode, 0 otherwise.
+ */
+int tickVirtualModeGet (void);
+
+/**
+ * @brief Advance virtual time.
+ *
+ * Announces @p nTicks ticks in a row, running the tick hooks for each.
+ * Timed waits in semLib, msgQLib and mboxLib whose timeout is reached are
+ * timed out and woken, and wdLib's service thread is woken for watchdogs
+ * that fall due, before it returns.
+ *
+ * @param nTicks Number of ticks to advance.
+ * @return 0 on success, -1 if virtual time mode is not active.
+ */
+int tickAdvance (uint64_t nTicks);
+
 /**
  * @brief Get the number of system ticks since initialization.
  *
@@ -45,6 +141,33 @@ int tickLibInit (int ticksPerSec);
  */
 uint64_t tickGet (void);
 
+/**
+ * @brief Set the tick counter.
+ *
+ * Equivalent to VxWorks ::tickSet.
+ *
+ * @param newTick New tick count.
+ */
+void tickSet (uint64_t newTick);
+
+/**
+ * @brief Get the number of overrun ticks.
+ *
+ * Counts ticks the tick thread had to announce late because it woke up
+ * after more than one period had elapsed. Overrun ticks are still counted
+ * by ::tickGet, so the tick count never falls behind real time.
+ *
+ * @return Total overrun ticks since initialization.
+ */
+uint64_t tickOverrunGet (void);
+
+/**
+ * @brief Get elapsed ticks since startup, computed from the clock.
+ *
+ * @return Ticks at the current rate, independent of the tick thread.
+ */
+uint64_t tickSinceBoot (void);
+
 /**
  * @brief Get the tick rate (ticks per second).
  *
@@ -57,7 +180,8 @@ int sysClkRateGet (void);
 /**
  * @brief Set the tick rate (ticks per second).
  *
- * Equivalent to VxWorks ::sysClkRateSet.
+ * Equivalent to VxWorks ::sysClkRateSet. A running tick thread picks up
+ * the new rate at once, continuing from the last tick it announced.
  *
  * @param ticksPerSec New tick frequency.
  * @return 0 on success, -1 on error.
@@ -80,6 +204,164 @@ uint64_t tickToMs (uint64_t ticks);
  */
 uint64_t msToTicks (uint64_t ms);
 
+/**
+ * @brief Tick hook routine.
+ *
+ * @param tick Tick count of the tick being announced.
+ * @param arg  Argument given to ::tickHookAdd.
+ */
+typedef void (*TICK_HOOK) (uint64_t tick, void *arg);
+
+/**
+ * @brief Run-time statistics of a tick hook.
+ */
+typedef struct
+{
+    uint64_t calls;     /**< Number of invocations */
+    uint64_t totalNs;   /**< Accumulated execution time (ns) */
+    uint64_t maxNs;     /**< Longest single execution (ns) */
+} TICK_HOOK_STATS;
+
+/**
+ * @brief Register a routine to be called on every tick.
+ *
+ * Equivalent to VxWorks ::tickAnnounceHookAdd. Hooks run on the tick
+ * thread in registration order and must be short; their execution time is
+ * measured so a slow hook can be found before it stretches the tick. A hook
+ * may add or delete hooks, including itself.
+ *
+ * @param hook Routine to call.
+ * @param arg  Argument passed to the routine.
+ * @return 0 on success, -1 on error.
+ */
+int tickHookAdd (TICK_HOOK hook, void *arg);
+
+/**
+ * @brief Remove a hook registered with ::tickHookAdd.
+ *
+ * After return the hook is no longer called (unless called from a hook).
+ *
+ * @param hook Routine passed to ::tickHookAdd.
+ * @param arg  Argument passed to ::tickHookAdd.
+ * @return 0 on success, -1 if no such hook is registered.
+ */
+int tickHookDelete (TICK_HOOK hook, void *arg);
+
+/**
+ * @brief Get the run-time statistics of a hook.
+ *
+ * @param hook   Routine passed to ::tickHookAdd.
+ * @param arg    Argument passed to ::tickHookAdd.
+ * @param pStats Receives the statistics.
+ * @return 0 on success, -1 if no such hook is registered.
+ */
+int tickHookStatsGet (TICK_HOOK hook, void *arg, TICK_HOOK_STATS *pStats);
+
+/**
+ * @brief Print all hooks with call count, average and maximum run time.
+ *
+ * Hooks whose longest run exceeds a tenth of the tick period are flagged.
+ */
+void tickHookShow (void);
+
+/**
+ * @brief Publish this process's tick domain in a shared-memory page.
+ *
+ * The calling process becomes the tick owner: every tick it announces, and
+ * every rate or mode change, is written to the page @p name (a POSIX shared
+ * memory object). Other processes map it read-only with ::tickShmAttach.
+ *
+ * @param name Name of the page, e.g. "/tick".
+ * @return 0 on success, -1 on error or if a page is already in use.
+ */
+int tickShmPublish (const char *name);
+
+/**
+ * @brief Join the tick domain published by another process.
+ *
+ * Maps the page read-only and stops the local tick thread. From then on
+ * ::tickGet is a load from the page, ::sysClkRateGet and the tick
+ * conversions use the owner's rate, and virtual time follows the owner.
+ * ::tickLibInit becomes a no-op; ::sysClkRateSet, ::tickSet,
+ * ::tickAnnounce and ::tickVirtualModeSet are refused or ignored, and tick
+ * hooks only run in the owner. Waits up to about a second for the owner to
+ * initialize the page.
+ *
+ * @param name Name given to ::tickShmPublish.
+ * @return 0 on success, -1 on error or if a page is already in use.
+ */
+int tickShmAttach (const char *name);
+
+/**
+ * @brief Stop publishing or reading the shared tick page.
+ *
+ * An owner stops updating the page (readers see time stop); a reader
+ * continues with a local count from the last shared value and may call
+ * ::tickLibInit to restart its tick thread.
+ *
+ * @return 0 on success, -1 if no page is in use.
+ */
+int tickShmDetach (void);
+
+/**
+ * @brief Remove the name of a shared tick page.
+ *
+ * Processes that already mapped it keep their mapping.
+ *
+ * @param name Name given to ::tickShmPublish.
+ * @return 0 on success, -1 on error.
+ */
+int tickShmUnlink (const char *name);
+
+/**
+ * @brief Calibrate the timestamp counter.
+ *
+ * Calibration measures the counter against CLOCK_MONOTONIC for about
+ * 10 ms. It happens on the first timestamp call anyway; calling this at
+ * start-up keeps that delay out of the first measurement.
+ *
+ * @return 0 if the hardware counter is used, -1 if timestamps fall back
+ *         to clock_gettime.
+ */
+int tickTimestampInit (void);
+
+/**
+ * @brief Read the high-resolution timestamp counter.
+ *
+ * Equivalent to VxWorks ::sysTimestamp, but 64 bits wide and free running.
+ * Reads the TSC on x86 when the CPU reports it invariant, the generic timer
+ * on AArch64, and CLOCK_MONOTONIC in nanoseconds otherwise. The read is not
+ * serializing; the counter origin is arbitrary, so use differences.
+ *
+ * @return Current counter value.
+ */
+uint64_t tickTimestamp (void);
+
+/**
+ * @brief Get the frequency of ::tickTimestamp.
+ *
+ * Equivalent to VxWorks ::sysTimestampFreq.
+ *
+ * @return Counts per second (1000000000 in the clock_gettime fallback).
+ */
+uint64_t tickTimestampFreq (void);
+
+/**
+ * @brief Convert timestamp counts to nanoseconds.
+ *
+ * @param counts Counter difference.
+ * @return Nanoseconds.
+ */
+uint64_t tickTimestampToNs (uint64_t counts);
+
+/**
+ * @brief Convert timestamp counts to ticks.
+ *
+ * @param counts Counter difference.
+ * @return Whole ticks at the current rate (rounded down).
+ */
+uint64_t tickTimestampToTicks (uint64_t counts);
+
 /** @} */
 
 #ifdef __cplusplus
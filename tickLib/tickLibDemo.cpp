@@ -14,7 +14,7 @@
 int main()
 {
     std::cout << "Initializing tickLib..." << std::endl;
-    if (tickLibInit() != 0)
+    if (tickLibInit(60) != 0)
     {
         std::cerr << "tickLibInit failed!" << std::endl;
         return -1;
@@ -25,13 +25,13 @@ int main()
     std::cout << "Sleeping 2 seconds (using std::this_thread::sleep_for)..." << std::endl;
     std::this_thread::sleep_for(std::chrono::seconds(2));
 
-    UINT tick1 = tickGet();
+    uint64_t tick1 = tickGet();
     std::cout << "Tick after 2s = " << tick1 << std::endl;
 
     std::cout << "Sleeping another 3 seconds..." << std::endl;
     std::this_thread::sleep_for(std::chrono::seconds(3));
 
-    UINT tick2 = tickGet();
+    uint64_t tick2 = tickGet();
     std::cout << "Tick after 5s total = " << tick2 << std::endl;
 
     std::cout << "Elapsed ticks = " << (tick2 - tick1) << std::endl;
@@ -50,6 +50,9 @@ int main()
     std::cout << "Sleeping 1 second and checking ticks again..." << std::endl;
     std::this_thread::sleep_for(std::chrono::seconds(1));
     std::cout << "Tick now = " << tickGet() << std::endl;
+    std::cout << "Overrun ticks = " << tickOverrunGet() << std::endl;
+
+    tickLibShutdown();
 
     std::cout << "Demo finished." << std::endl;
     return 0;
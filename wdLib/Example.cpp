@@ -18,7 +18,7 @@ void criticalTask(WDOG_ID watchdogId)
     
     // Start watchdog with 2-second timeout (200 ticks at 100 ticks/sec)
     const char* taskName = "CriticalTask";
-    if (wdStart(watchdogId, 200, watchdogCallback, reinterpret_cast<uintptr_t>(taskName)) 
+    if (wdStart(watchdogId, 200, watchdogCallback, reinterpret_cast<uintptr_t>(taskName)) != 0) 
 	{
         std::cerr << "Failed to start watchdog" << std::endl;
         return;
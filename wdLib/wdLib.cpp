@@ -7,20 +7,142 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <sched.h>
+
+/*
+ * All watchdogs share one timer-service thread and a hierarchical timing
+ * wheel keyed on ticks: 256 one-tick slots, then three levels of 64 slots
+ * that each cover 64 times the span of the level below (2^26 ticks in
+ * total). A watchdog sits in exactly one slot list, so wdStart and
+ * wdCancel are O(1) list operations under one global mutex. Every 256
+ * ticks the next slot of the level above is cascaded down.
+ *
+ * Expired handlers are queued to a prestarted worker pool (wdPoolConfig);
+ * handlers of WD_OPT_INLINE watchdogs, or all of them with an empty pool,
+ * run directly on the service thread. Either way the mutex is released
+ * while a handler runs, and its run time is accounted to the watchdog.
+ *
+ * Watchdog arrays (wdArrayCreate) put their entries on the same wheel. An
+ * entry also carries a deadline word that wdArrayKick moves forward with a
+ * CAS and no lock; the wheel only notices when the stale slot comes due and
+ * then re-inserts the entry at its current deadline.
+ */
+
+#define WD_L0_BITS   8
+#define WD_LN_BITS   6
+#define WD_L0_SIZE   (1 << WD_L0_BITS)
+#define WD_LN_SIZE   (1 << WD_LN_BITS)
+#define WD_LEVELS    4
+#define WD_MAX_DELTA ((1ULL << (WD_L0_BITS + 3 * WD_LN_BITS)) - 1)
+
+#define WD_SLOT_NONE    (-1)    // not armed
+#define WD_SLOT_PENDING (-2)    // expired, waiting for its handler to run
+
+#define WD_POOL_MAX     64
+#define WD_POOL_DEFAULT 1       // one worker keeps handlers in expiry order
+
+#define WD_VIRTUAL_RECHECK_MS 1000  // virtual time: real-time wait between mode checks
+
+typedef struct WdLink {
+    struct WdLink* next;
+    struct WdLink* prev;
+} WdLink;
+
+/* What the wheel stores: a watchdog or one entry of a watchdog array */
+typedef struct WdNode {
+    WdLink          link;           // first member: slot list node
+    uint64_t        expiry;         // absolute tick on the wheel clock
+    int16_t         level;          // wheel level, or WD_SLOT_*
+    int16_t         slot;
+    int32_t         index;          // entry index in its WdArray, -1 for a WdControl
+} WdNode;
 
 typedef struct WdControl {
-    pthread_mutex_t mtx;
-    pthread_cond_t  cv;
-    pthread_t       thread;
-    int             threadRunning;  // 0/1
-    int             active;         // 0/1
-    int             canceled;       // 0/1
-    unsigned long long generation;
+    WdNode          node;           // first member
+    int             deleted;        // wdDelete called from its own handler
+    int             options;        // WD_OPT_*
+    int             inFlight;       // handlers currently executing
+    int             queuedRun;      // runLink is on g_wd.queue
     WDOG_HANDLER    handler;
     uintptr_t       arg;
-    struct timespec deadline;       // absolute CLOCK_MONOTONIC deadline
+    uint64_t        period;         // ticks between expiries, 0 for one-shot
+    uint64_t        overruns;       // periods skipped because the handler was still busy
+    uint64_t        dueNs;          // CLOCK_MONOTONIC deadline of the pending run
+    WdLink          runLink;        // on g_wd.queue while a run waits for a worker
+    WdLink          allLink;        // on g_wd.all, for wdPoolShow
+    WD_HANDLER_STATS stats;
 } WdControl;
 
+#define WD_FROM_RUN(l) ((WdControl*)((char*)(l) - offsetof(WdControl, runLink)))
+#define WD_FROM_ALL(l) ((WdControl*)((char*)(l) - offsetof(WdControl, allLink)))
+
+typedef struct WdArrayEntry {
+    WdNode          node;           // first member
+    uint64_t        deadline;       // wheel tick; 0 = disarmed; kicked by CAS without the mutex
+} WdArrayEntry;
+
+typedef struct WdArray {
+    WD_ARRAY_HANDLER handler;
+    uintptr_t       arg;
+    int             n;
+    int             deleted;        // wdArrayDelete called from its own handler
+    int             inFlight;
+    WdArrayEntry    entry[1];       // n entries
+} WdArray;
+
+/* Array that owns an entry: entries are addressed by index, so step back to entry[0] */
+#define WD_ARRAY_OF(e) ((WdArray*)((char*)((e) - (e)->node.index) - offsetof(WdArray, entry)))
+
+typedef struct WdWheel {
+    pthread_mutex_t mtx;
+    pthread_cond_t  cv;             // wakes the service thread
+    pthread_cond_t  done;           // a handler finished
+    pthread_t       thread;
+    WdLink          l0[WD_L0_SIZE];
+    WdLink          ln[WD_LEVELS - 1][WD_LN_SIZE];
+    uint64_t        l0Map[WD_L0_SIZE / 64];   // non-empty level-0 slots
+    uint64_t        now;            // next tick to process
+    uint64_t        wakeTick;       // tick the service thread sleeps until
+    unsigned long   armed;
+    uint64_t        wakeups;        // service thread passes through the wheel
+    uint64_t        expirations;
+    uint64_t        maxPerTick;
+    uint64_t        startNs;
+    uint64_t        startTick;
+    WD_HIST         latency;        // all handlers; updated without the mutex
+    WD_HIST         runTime;
+    WdLink          all;            // every watchdog
+    WdLink          queue;          // expired watchdogs for the pool
+
+    // handler pool
+    pthread_cond_t  work;           // queue not empty / pool shrunk
+    pthread_t       workers[WD_POOL_MAX];
+    int             nWorkers;       // workers with index >= nWorkers exit
+    int             poolPriority;
+    unsigned long   queued;
+
+    // wheel clock: ticks at sysClkRateGet() from CLOCK_MONOTONIC, or tickLib virtual ticks.
+    // Starts at 1 so that 0 can mean "disarmed". The base fields change under
+    // the mutex inside clockSeq (odd while writing) so wdArrayKick can read them.
+    unsigned        clockSeq;
+    uint64_t        clock;
+    uint64_t        baseClock;
+    uint64_t        baseNs;
+    uint64_t        baseVirtual;
+    uint64_t        tps;
+    int             virtualTime;
+    int             tickHooked;     // wd_tick_hook registered; service thread only
+} WdWheel;
+
+static WdWheel g_wd;
+static pthread_once_t g_wdOnce = PTHREAD_ONCE_INIT;
+static int g_wdReady = 0;
+static pthread_mutex_t g_wdPoolLock = PTHREAD_MUTEX_INITIALIZER;   // serializes wdPoolConfig
+static __thread WdControl* t_wdCurrent = NULL;  // watchdog whose handler this thread runs
+static __thread WdArray* t_wdArrayCurrent = NULL;   // array whose handler this thread runs
+
 static int add_ms_to_timespec(struct timespec* ts, unsigned long long ms) {
     const long NS_PER_MS = 1000000L;
     if (!ts) return -1;
@@ -33,97 +155,582 @@ static int add_ms_to_timespec(struct timespec* ts, unsigned long long ms) {
     return 0;
 }
 
-static void* wd_worker(void* arg) {
-    WdControl* wd = (WdControl*)arg;
-    pthread_mutex_lock(&wd->mtx);
-    unsigned long long myGen = wd->generation;
-    struct timespec deadline = wd->deadline;
+static uint64_t wd_mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static inline void link_init(WdLink* l) { l->next = l->prev = l; }
+static inline int  link_empty(const WdLink* l) { return l->next == l; }
+
+static inline void link_append(WdLink* head, WdLink* l) {
+    l->prev = head->prev;
+    l->next = head;
+    head->prev->next = l;
+    head->prev = l;
+}
+
+static inline void link_remove(WdLink* l) {
+    l->prev->next = l->next;
+    l->next->prev = l->prev;
+    l->next = l->prev = l;
+}
+
+#define WD_LOAD(x)      __atomic_load_n(&(x), __ATOMIC_RELAXED)
+#define WD_STORE(x, v)  __atomic_store_n(&(x), (v), __ATOMIC_RELAXED)
+
+/* Move the clock base (caller holds g_wd.mtx) */
+static void wd_clock_rebase(int virt, uint64_t vt, uint64_t ns, uint64_t tps) {
+    __atomic_store_n(&g_wd.clockSeq, g_wd.clockSeq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    WD_STORE(g_wd.baseClock, g_wd.clock);
+    WD_STORE(g_wd.virtualTime, virt);
+    if (virt) {
+        WD_STORE(g_wd.baseVirtual, vt);
+    } else {
+        WD_STORE(g_wd.baseNs, ns);
+        WD_STORE(g_wd.tps, tps);
+    }
+    __atomic_store_n(&g_wd.clockSeq, g_wd.clockSeq + 1, __ATOMIC_RELEASE);
+}
+
+static uint64_t wd_clock_from(uint64_t baseClock, uint64_t baseNs, uint64_t tps, uint64_t ns) {
+    uint64_t d = ns > baseNs ? ns - baseNs : 0;
+    return baseClock + (d / 1000000000ULL) * tps + ((d % 1000000000ULL) * tps) / 1000000000ULL;
+}
+
+/* Current tick of the wheel clock (caller holds g_wd.mtx); never goes back */
+static uint64_t wd_clock_locked(void) {
+    uint64_t now;
+    if (tickVirtualModeGet()) {
+        uint64_t vt = tickGet();
+        if (!g_wd.virtualTime) wd_clock_rebase(1, vt, 0, 0);
+        now = g_wd.baseClock + (vt > g_wd.baseVirtual ? vt - g_wd.baseVirtual : 0);
+    } else {
+        int rate = sysClkRateGet();
+        uint64_t tps = rate > 0 ? (uint64_t)rate : 60;
+        uint64_t ns = wd_mono_ns();
+        if (g_wd.virtualTime || tps != g_wd.tps) wd_clock_rebase(0, 0, ns, tps);
+        now = wd_clock_from(g_wd.baseClock, g_wd.baseNs, tps, ns);
+    }
+    if (now > g_wd.clock) WD_STORE(g_wd.clock, now);
+    return g_wd.clock;
+}
+
+/* Wheel clock without the mutex, for wdArrayKick. May lag wd_clock_locked
+   by a tick around a rate or mode change, which only delays a kicked entry. */
+static uint64_t wd_clock_peek(void) {
     for (;;) {
-        if (!wd->active || wd->canceled || wd->generation != myGen) {
-            // cancelled or superseded
-            pthread_mutex_unlock(&wd->mtx);
-            return NULL;
+        unsigned seq = __atomic_load_n(&g_wd.clockSeq, __ATOMIC_ACQUIRE);
+        if (seq & 1) { sched_yield(); continue; }
+        int virt = WD_LOAD(g_wd.virtualTime);
+        uint64_t baseClock = WD_LOAD(g_wd.baseClock);
+        uint64_t baseNs = WD_LOAD(g_wd.baseNs);
+        uint64_t baseVirtual = WD_LOAD(g_wd.baseVirtual);
+        uint64_t tps = WD_LOAD(g_wd.tps);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&g_wd.clockSeq, __ATOMIC_RELAXED) != seq) continue;
+
+        uint64_t now = WD_LOAD(g_wd.clock);
+        if (virt != tickVirtualModeGet()) return now;   // not rebased yet
+        uint64_t c;
+        if (virt) {
+            uint64_t vt = tickGet();
+            c = baseClock + (vt > baseVirtual ? vt - baseVirtual : 0);
+        } else {
+            c = wd_clock_from(baseClock, baseNs, tps, wd_mono_ns());
+        }
+        return c > now ? c : now;
+    }
+}
+
+/* Absolute CLOCK_MONOTONIC time at which the wheel clock reaches @tick (real time only) */
+static struct timespec wd_tick_deadline(uint64_t tick) {
+    uint64_t k = tick > g_wd.baseClock ? tick - g_wd.baseClock : 0;
+    uint64_t tps = g_wd.tps;
+    uint64_t ns = g_wd.baseNs + (k / tps) * 1000000000ULL + ((k % tps) * 1000000000ULL + tps - 1) / tps;
+    struct timespec ts;
+    ts.tv_sec = (time_t)(ns / 1000000000ULL);
+    ts.tv_nsec = (long)(ns % 1000000000ULL);
+    return ts;
+}
+
+/* Add one sample; callable without the mutex, readers use wd_hist_read */
+static void wd_hist_add(WD_HIST* h, uint64_t ns) {
+    uint64_t us = ns / 1000;
+    int b = us == 0 ? 0 : 64 - __builtin_clzll(us);
+    if (b >= WD_HIST_BUCKETS) b = WD_HIST_BUCKETS - 1;
+    __atomic_fetch_add(&h->count[b], 1, __ATOMIC_RELAXED);
+    uint64_t m = __atomic_load_n(&h->maxNs, __ATOMIC_RELAXED);
+    while (ns > m && !__atomic_compare_exchange_n(&h->maxNs, &m, ns, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+
+static void wd_hist_read(WD_HIST* dst, WD_HIST* src) {
+    for (int i = 0; i < WD_HIST_BUCKETS; i++)
+        dst->count[i] = __atomic_load_n(&src->count[i], __ATOMIC_RELAXED);
+    dst->maxNs = __atomic_load_n(&src->maxNs, __ATOMIC_RELAXED);
+}
+
+/* CLOCK_MONOTONIC time a handler due at @tick should start (caller holds g_wd.mtx).
+   Virtual ticks have no wall-clock deadline: use the time the wheel reached it. */
+static uint64_t wd_due_ns(uint64_t tick) {
+    if (g_wd.virtualTime) return wd_mono_ns();
+    struct timespec ts = wd_tick_deadline(tick);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* Latency and run time of one handler run, into @own and the global histograms */
+static void wd_account(WD_HIST* ownLatency, WD_HIST* ownRunTime, uint64_t dueNs, uint64_t t0, uint64_t ns) {
+    uint64_t late = t0 > dueNs ? t0 - dueNs : 0;
+    if (ownLatency) wd_hist_add(ownLatency, late);
+    if (ownRunTime) wd_hist_add(ownRunTime, ns);
+    wd_hist_add(&g_wd.latency, late);
+    wd_hist_add(&g_wd.runTime, ns);
+}
+
+/* Put an armed node into the slot for its expiry (caller holds g_wd.mtx) */
+static void wd_insert(WdNode* node) {
+    uint64_t expiry = node->expiry < g_wd.now ? g_wd.now : node->expiry;
+    uint64_t delta = expiry - g_wd.now;
+    if (delta > WD_MAX_DELTA) {
+        expiry = g_wd.now + WD_MAX_DELTA;   // parked; re-sorted when cascaded
+        delta = WD_MAX_DELTA;
+    }
+
+    if (delta < WD_L0_SIZE) {
+        int idx = (int)(expiry & (WD_L0_SIZE - 1));
+        node->level = 0;
+        node->slot = (int16_t)idx;
+        link_append(&g_wd.l0[idx], &node->link);
+        g_wd.l0Map[idx / 64] |= 1ULL << (idx % 64);
+        return;
+    }
+    int level = 1;
+    while (level < WD_LEVELS - 1 && delta >= (1ULL << (WD_L0_BITS + level * WD_LN_BITS)))
+        level++;
+    int shift = WD_L0_BITS + (level - 1) * WD_LN_BITS;
+    int idx = (int)((expiry >> shift) & (WD_LN_SIZE - 1));
+    node->level = (int16_t)level;
+    node->slot = (int16_t)idx;
+    link_append(&g_wd.ln[level - 1][idx], &node->link);
+}
+
+/* Take a node off the wheel or the pending list (caller holds g_wd.mtx) */
+static void wd_node_unlink(WdNode* node) {
+    if (node->level == WD_SLOT_NONE) return;
+    link_remove(&node->link);
+    if (node->level == 0 && link_empty(&g_wd.l0[node->slot]))
+        g_wd.l0Map[node->slot / 64] &= ~(1ULL << (node->slot % 64));
+    g_wd.armed--;
+    node->level = WD_SLOT_NONE;
+}
+
+/* Disarm a watchdog and drop a queued run that has not started (caller holds g_wd.mtx) */
+static void wd_unlink(WdControl* wd) {
+    if (wd->queuedRun) {
+        link_remove(&wd->runLink);
+        wd->queuedRun = 0;
+        g_wd.queued--;
+    }
+    wd_node_unlink(&wd->node);
+}
+
+/* Re-sort one upper-level slot into the levels below; returns the slot index */
+static int wd_cascade(int level) {
+    int shift = WD_L0_BITS + (level - 1) * WD_LN_BITS;
+    int idx = (int)((g_wd.now >> shift) & (WD_LN_SIZE - 1));
+    WdLink list;
+    link_init(&list);
+    WdLink* head = &g_wd.ln[level - 1][idx];
+    if (!link_empty(head)) {
+        // splice the slot out, then reinsert each entry
+        list.next = head->next;
+        list.prev = head->prev;
+        list.next->prev = &list;
+        list.prev->next = &list;
+        link_init(head);
+    }
+    while (!link_empty(&list)) {
+        WdNode* node = (WdNode*)list.next;
+        link_remove(&node->link);
+        wd_insert(node);
+    }
+    return idx;
+}
+
+/* Release a watchdog that is off every list and not running (caller holds g_wd.mtx) */
+static void wd_free_locked(WdControl* wd) {
+    link_remove(&wd->allLink);
+    free(wd);
+}
+
+/* Run one expired watchdog's handler with the mutex released, timing it;
+   returns 0 if the handler deleted the watchdog and it has been freed */
+static int wd_run(WdControl* wd) {
+    WDOG_HANDLER fn = wd->handler;
+    uintptr_t a = wd->arg;
+    uint64_t dueNs = wd->dueNs;
+    WdControl* outer = t_wdCurrent;
+    wd->inFlight++;
+    t_wdCurrent = wd;
+    pthread_mutex_unlock(&g_wd.mtx);
+
+    uint64_t t0 = wd_mono_ns();
+    if (fn) fn(a);
+    uint64_t ns = wd_mono_ns() - t0;
+    wd_account(&wd->stats.latency, &wd->stats.runTime, dueNs, t0, ns);
+
+    pthread_mutex_lock(&g_wd.mtx);
+    t_wdCurrent = outer;
+    wd->stats.runs++;
+    wd->stats.totalNs += ns;
+    if (ns > wd->stats.maxNs) wd->stats.maxNs = ns;
+    if (--wd->inFlight == 0) {
+        if (wd->deleted) {
+            wd_free_locked(wd);
+            return 0;
+        }
+        pthread_cond_broadcast(&g_wd.done);
+    }
+    return 1;
+}
+
+/* Hand an expired watchdog to the pool, or run it here (caller holds g_wd.mtx) */
+static void wd_fire(WdControl* wd, uint64_t dueTick) {
+    if (wd->period && (wd->queuedRun || wd->inFlight > 0)) {
+        wd->overruns++;     // previous period's handler has not finished
+        return;
+    }
+    if (!wd->queuedRun) wd->dueNs = wd_due_ns(dueTick);
+    if (g_wd.nWorkers > 0 && !(wd->options & WD_OPT_INLINE)) {
+        if (!wd->queuedRun) {
+            wd->queuedRun = 1;
+            link_append(&g_wd.queue, &wd->runLink);
+            g_wd.queued++;
+            pthread_cond_signal(&g_wd.work);
+        }
+        return;
+    }
+    if (!wd_run(wd) || !wd->period || wd->node.level < 0) return;
+
+    // The wheel stood still while the handler ran here. Deadlines that passed
+    // meanwhile are overruns, as on the pool, not runs to replay back to back.
+    uint64_t now = wd_clock_locked();
+    if (wd->node.expiry < now) {
+        uint64_t missed = (now - wd->node.expiry + wd->period - 1) / wd->period;
+        wd_node_unlink(&wd->node);
+        wd->node.expiry += missed * wd->period;
+        wd->overruns += missed;
+        wd_insert(&wd->node);
+        g_wd.armed++;
+    }
+}
+
+/* An array entry's slot came due: re-insert it if it was kicked since,
+   otherwise disarm it and run the handler here; returns 1 if it fired
+   (caller holds g_wd.mtx) */
+static int wd_array_expire(WdArrayEntry* e) {
+    uint64_t d = __atomic_load_n(&e->deadline, __ATOMIC_ACQUIRE);
+    while (d != 0) {
+        if (d >= g_wd.now) {
+            // kicked: lazy re-insertion at the current deadline
+            e->node.expiry = d;
+            wd_insert(&e->node);
+            g_wd.armed++;
+            return 0;
         }
-        int rc = pthread_cond_timedwait(&wd->cv, &wd->mtx, &deadline);
-        if (rc == ETIMEDOUT) {
-            // Time to fire if still valid
-            if (wd->active && !wd->canceled && wd->generation == myGen) {
-                WDOG_HANDLER fn = wd->handler;
-                uintptr_t a = wd->arg;
-                wd->active = 0;
-                pthread_mutex_unlock(&wd->mtx);
-                if (fn) fn(a);
-                return NULL;
-            } else {
-                pthread_mutex_unlock(&wd->mtx);
-                return NULL;
+        if (__atomic_compare_exchange_n(&e->deadline, &d, 0, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            break;
+    }
+    if (d == 0) return 0;
+
+    WdArray* arr = WD_ARRAY_OF(e);
+    WdArray* outer = t_wdArrayCurrent;
+    uint64_t dueNs = wd_due_ns(d);
+    arr->inFlight++;
+    t_wdArrayCurrent = arr;
+    pthread_mutex_unlock(&g_wd.mtx);
+    uint64_t t0 = wd_mono_ns();
+    arr->handler(arr, e->node.index, arr->arg);
+    wd_account(NULL, NULL, dueNs, t0, wd_mono_ns() - t0);
+    pthread_mutex_lock(&g_wd.mtx);
+    t_wdArrayCurrent = outer;
+    if (--arr->inFlight == 0) {
+        if (arr->deleted) free(arr);
+        else pthread_cond_broadcast(&g_wd.done);
+    }
+    return 1;
+}
+
+/* Pop the oldest queued run (caller holds g_wd.mtx, queue not empty) */
+static WdControl* wd_dequeue(void) {
+    WdControl* wd = WD_FROM_RUN(g_wd.queue.next);
+    link_remove(&wd->runLink);
+    wd->queuedRun = 0;
+    g_wd.queued--;
+    return wd;
+}
+
+static void* wd_worker(void* p) {
+    int index = (int)(intptr_t)p;
+    pthread_mutex_lock(&g_wd.mtx);
+    for (;;) {
+        while (link_empty(&g_wd.queue) && index < g_wd.nWorkers)
+            pthread_cond_wait(&g_wd.work, &g_wd.mtx);
+        if (index >= g_wd.nWorkers) break;
+
+        wd_run(wd_dequeue());
+    }
+    pthread_mutex_unlock(&g_wd.mtx);
+    return NULL;
+}
+
+/* Apply the pool priority to one worker; 0 selects SCHED_OTHER */
+static int wd_worker_sched(pthread_t t, int prio) {
+    struct sched_param sp;
+    memset(&sp, 0, sizeof(sp));
+    sp.sched_priority = prio;
+    return pthread_setschedparam(t, prio > 0 ? SCHED_FIFO : SCHED_OTHER, &sp) == 0 ? 0 : -1;
+}
+
+/* Start or stop workers until nWorkers run (caller holds g_wdPoolLock, not g_wd.mtx) */
+static int wd_pool_resize(int nWorkers, int prio) {
+    int status = 0;
+    pthread_mutex_lock(&g_wd.mtx);
+    int old = g_wd.nWorkers;
+    g_wd.poolPriority = prio;
+    if (nWorkers < old) {
+        g_wd.nWorkers = nWorkers;
+        pthread_cond_broadcast(&g_wd.work);
+    }
+    pthread_mutex_unlock(&g_wd.mtx);
+
+    for (int i = nWorkers; i < old; i++)
+        pthread_join(g_wd.workers[i], NULL);
+    if (nWorkers == 0) {
+        // nobody is left to serve the queue: run what is waiting here
+        pthread_mutex_lock(&g_wd.mtx);
+        while (!link_empty(&g_wd.queue))
+            wd_run(wd_dequeue());
+        pthread_mutex_unlock(&g_wd.mtx);
+    }
+    for (int i = old; i < nWorkers; i++) {
+        pthread_mutex_lock(&g_wd.mtx);
+        g_wd.nWorkers = i + 1;
+        int rc = pthread_create(&g_wd.workers[i], NULL, wd_worker, (void*)(intptr_t)i);
+        if (rc != 0) g_wd.nWorkers = i;
+        pthread_mutex_unlock(&g_wd.mtx);
+        if (rc != 0) return -1;
+    }
+    for (int i = 0; i < nWorkers; i++) {
+        if (wd_worker_sched(g_wd.workers[i], prio) != 0) status = -1;
+    }
+    return status;
+}
+
+/* Process all ticks up to and including @until (caller holds g_wd.mtx) */
+static void wd_advance(uint64_t until) {
+    while (g_wd.now <= until) {
+        int idx = (int)(g_wd.now & (WD_L0_SIZE - 1));
+        if (idx == 0 && wd_cascade(1) == 0 && wd_cascade(2) == 0)
+            wd_cascade(3);
+
+        WdLink* head = &g_wd.l0[idx];
+        if (link_empty(head)) {
+            // skip straight to the next non-empty slot or cascade point
+            uint64_t next = (g_wd.now | (WD_L0_SIZE - 1)) + 1;
+            for (int i = idx + 1; i < WD_L0_SIZE; i++) {
+                if (g_wd.l0Map[i / 64] & (1ULL << (i % 64))) {
+                    next = g_wd.now + (uint64_t)(i - idx);
+                    break;
+                }
+            }
+            g_wd.now = next < until + 1 ? next : until + 1;
+            continue;
+        }
+
+        WdLink pending;
+        link_init(&pending);
+        while (!link_empty(head)) {
+            WdNode* node = (WdNode*)head->next;
+            link_remove(&node->link);
+            link_append(&pending, &node->link);
+            node->level = WD_SLOT_PENDING;
+        }
+        g_wd.l0Map[idx / 64] &= ~(1ULL << (idx % 64));
+        g_wd.now++;
+
+        // wdCancel/wdStart from other threads may pull entries off the pending list
+        uint64_t fired = 0;
+        while (!link_empty(&pending)) {
+            WdNode* node = (WdNode*)pending.next;
+            link_remove(&node->link);
+            node->level = WD_SLOT_NONE;
+            g_wd.armed--;
+            if (node->index >= 0) {
+                fired += wd_array_expire((WdArrayEntry*)node);   // may release the mutex
+                continue;
             }
-        } else if (rc == 0) {
-            // Woken up early; loop to re-check predicate
+            fired++;
+            WdControl* wd = (WdControl*)node;
+            uint64_t due = wd->node.expiry;
+            if (wd->period) {
+                // next deadline counts from this one, not from now: no drift
+                wd->node.expiry += wd->period;
+                wd_insert(&wd->node);
+                g_wd.armed++;
+            }
+            wd_fire(wd, due);   // may release the mutex
+        }
+        g_wd.expirations += fired;
+        if (fired > g_wd.maxPerTick) g_wd.maxPerTick = fired;
+    }
+}
+
+/* Expiry in [lo, lo + slack] with the most trailing zero bits, so that
+   timers with slack share wheel slots and the service thread wakes once */
+static uint64_t wd_slack_expiry(uint64_t lo, uint64_t slack) {
+    uint64_t hi = lo + slack;
+    if (hi == lo) return lo;
+    int b = 63 - __builtin_clzll(hi ^ lo);  // highest bit where lo and hi differ
+    return hi & ~((1ULL << b) - 1);
+}
+
+/* Tick at which the service thread next has work (caller holds g_wd.mtx) */
+static uint64_t wd_next_tick(void) {
+    int idx = (int)(g_wd.now & (WD_L0_SIZE - 1));
+    for (int i = idx; i < WD_L0_SIZE; i++) {
+        if (g_wd.l0Map[i / 64] & (1ULL << (i % 64)))
+            return g_wd.now + (uint64_t)(i - idx);
+    }
+    return (g_wd.now | (WD_L0_SIZE - 1)) + 1;   // next cascade
+}
+
+/* Tick hook, registered while the wheel runs on virtual time: wakes the
+   service thread when a tick reaches wakeTick or virtual time has ended */
+static void wd_tick_hook(uint64_t tick, void* arg) {
+    (void)tick;
+    (void)arg;
+    if (!tickVirtualModeGet() && !WD_LOAD(g_wd.virtualTime)) return;
+    pthread_mutex_lock(&g_wd.mtx);
+    int wasVirtual = g_wd.virtualTime;
+    if (wd_clock_locked() >= g_wd.wakeTick || g_wd.virtualTime != wasVirtual)
+        pthread_cond_signal(&g_wd.cv);
+    pthread_mutex_unlock(&g_wd.mtx);
+}
+
+static void* wd_service(void* unused) {
+    (void)unused;
+    pthread_mutex_lock(&g_wd.mtx);
+    for (;;) {
+        g_wd.wakeups++;
+        wd_advance(wd_clock_locked());
+        if (g_wd.tickHooked != g_wd.virtualTime) {
+            // the hook takes the mutex and tickHookDelete waits for it to return
+            int virt = g_wd.virtualTime;
+            pthread_mutex_unlock(&g_wd.mtx);
+            if (virt) tickHookAdd(wd_tick_hook, NULL);
+            else tickHookDelete(wd_tick_hook, NULL);
+            pthread_mutex_lock(&g_wd.mtx);
+            g_wd.tickHooked = virt;
+            continue;   // ticks may have passed meanwhile
+        }
+        if (g_wd.armed == 0) {
+            g_wd.wakeTick = UINT64_MAX;
+            pthread_cond_wait(&g_wd.cv, &g_wd.mtx);
             continue;
+        }
+
+        g_wd.wakeTick = wd_next_tick();
+        struct timespec deadline;
+        if (g_wd.virtualTime) {
+            // virtual time: wd_tick_hook wakes us from tickAdvance() once the
+            // wheel reaches wakeTick. tickVirtualModeSet(0) runs no hook, so
+            // look at the mode again after WD_VIRTUAL_RECHECK_MS.
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+            add_ms_to_timespec(&deadline, WD_VIRTUAL_RECHECK_MS);
         } else {
-            // Error; treat as cancel
-            pthread_mutex_unlock(&wd->mtx);
-            return NULL;
+            deadline = wd_tick_deadline(g_wd.wakeTick);
         }
+        pthread_cond_timedwait(&g_wd.cv, &g_wd.mtx, &deadline);
+    }
+    return NULL;
+}
+
+static void wd_init(void) {
+    pthread_condattr_t cattr;
+    pthread_condattr_init(&cattr);
+    pthread_condattr_setclock(&cattr, CLOCK_MONOTONIC);   // deadlines are CLOCK_MONOTONIC
+    pthread_mutex_init(&g_wd.mtx, NULL);
+    pthread_cond_init(&g_wd.cv, &cattr);
+    pthread_cond_init(&g_wd.done, NULL);
+    pthread_cond_init(&g_wd.work, NULL);
+    pthread_condattr_destroy(&cattr);
+    link_init(&g_wd.all);
+    link_init(&g_wd.queue);
+
+    for (int i = 0; i < WD_L0_SIZE; i++) link_init(&g_wd.l0[i]);
+    for (int l = 0; l < WD_LEVELS - 1; l++)
+        for (int i = 0; i < WD_LN_SIZE; i++) link_init(&g_wd.ln[l][i]);
+    g_wd.wakeTick = UINT64_MAX;
+
+    pthread_mutex_lock(&g_wd.mtx);
+    g_wd.clock = 1;
+    g_wd.now = wd_clock_locked() + 1;
+    g_wd.startNs = wd_mono_ns();
+    g_wd.startTick = g_wd.now;
+    pthread_mutex_unlock(&g_wd.mtx);
+
+    if (pthread_create(&g_wd.thread, NULL, wd_service, NULL) == 0) {
+        pthread_detach(g_wd.thread);
+        g_wdReady = 1;
     }
+    pthread_mutex_lock(&g_wdPoolLock);
+    if (g_wd.nWorkers == 0) wd_pool_resize(WD_POOL_DEFAULT, 0);
+    pthread_mutex_unlock(&g_wdPoolLock);
 }
 
 WDOG_ID wdCreate(void) {
+    pthread_once(&g_wdOnce, wd_init);
+    if (!g_wdReady) return NULL;
     WdControl* wd = (WdControl*)calloc(1, sizeof(WdControl));
     if (!wd) return NULL;
-    if (pthread_mutex_init(&wd->mtx, NULL) != 0) { free(wd); return NULL; }
-    if (pthread_cond_init(&wd->cv, NULL) != 0) { pthread_mutex_destroy(&wd->mtx); free(wd); return NULL; }
-    wd->threadRunning = 0;
-    wd->active = 0;
-    wd->canceled = 0;
-    wd->generation = 0;
-    wd->handler = NULL;
-    wd->arg = 0;
-    wd->deadline.tv_sec = 0;
-    wd->deadline.tv_nsec = 0;
+    link_init(&wd->node.link);
+    link_init(&wd->runLink);
+    wd->node.level = WD_SLOT_NONE;
+    wd->node.index = -1;
+    pthread_mutex_lock(&g_wd.mtx);
+    link_append(&g_wd.all, &wd->allLink);
+    pthread_mutex_unlock(&g_wd.mtx);
     return wd;
 }
 
 int wdDelete(WDOG_ID id) {
     if (!id) return -1;
     WdControl* wd = (WdControl*)id;
-    // cancel and join if needed
-    pthread_mutex_lock(&wd->mtx);
-    wd->canceled = 1;
-    wd->active = 0;
-    wd->generation++;
-    pthread_cond_broadcast(&wd->cv);
-    pthread_mutex_unlock(&wd->mtx);
-
-    if (wd->threadRunning) {
-        pthread_join(wd->thread, NULL);
-        wd->threadRunning = 0;
-    }
-    pthread_cond_destroy(&wd->cv);
-    pthread_mutex_destroy(&wd->mtx);
-    free(wd);
+    pthread_mutex_lock(&g_wd.mtx);
+    wd_unlink(wd);
+    if (t_wdCurrent == wd) {
+        // deleted from its own handler: freed once the last handler run returns
+        wd->deleted = 1;
+        pthread_mutex_unlock(&g_wd.mtx);
+        return 0;
+    }
+    while (wd->inFlight > 0)
+        pthread_cond_wait(&g_wd.done, &g_wd.mtx);
+    wd_free_locked(wd);
+    pthread_mutex_unlock(&g_wd.mtx);
     return 0;
 }
 
 int wdCancel(WDOG_ID id) {
     if (!id) return -1;
     WdControl* wd = (WdControl*)id;
-    pthread_mutex_lock(&wd->mtx);
-    if (!wd->active) {
-        pthread_mutex_unlock(&wd->mtx);
-        return 0;
-    }
-    wd->canceled = 1;
-    wd->active = 0;
-    wd->generation++;
-    pthread_cond_broadcast(&wd->cv);
-    pthread_mutex_unlock(&wd->mtx);
-
-    if (wd->threadRunning) {
-        pthread_join(wd->thread, NULL);
-        wd->threadRunning = 0;
-    }
+    pthread_mutex_lock(&g_wd.mtx);
+    wd_unlink(wd);
+    pthread_mutex_unlock(&g_wd.mtx);
     return 0;
 }
 
@@ -131,42 +738,281 @@ int wdStart(WDOG_ID id, int delayTicks, WDOG_HANDLER func, uintptr_t arg) {
     if (!id || !func || delayTicks < 0) return -1;
     WdControl* wd = (WdControl*)id;
 
-    // cancel any existing timer
-    (void)wdCancel(id);
+    pthread_mutex_lock(&g_wd.mtx);
+    wd_unlink(wd);
+    wd->handler = func;
+    wd->arg = arg;
+    wd->period = 0;
+    wd->node.expiry = wd_clock_locked() + (uint64_t)delayTicks;
+    wd_insert(&wd->node);
+    g_wd.armed++;
+    if (wd->node.expiry < g_wd.wakeTick)
+        pthread_cond_signal(&g_wd.cv);  // earlier than the service thread planned
+    pthread_mutex_unlock(&g_wd.mtx);
+    return 0;
+}
+
+int wdStartSlack(WDOG_ID id, int delayTicks, int slackTicks, WDOG_HANDLER func, uintptr_t arg) {
+    if (!id || !func || delayTicks < 0 || slackTicks < 0) return -1;
+    WdControl* wd = (WdControl*)id;
+
+    pthread_mutex_lock(&g_wd.mtx);
+    wd_unlink(wd);
+    wd->handler = func;
+    wd->arg = arg;
+    wd->period = 0;
+    wd->node.expiry = wd_slack_expiry(wd_clock_locked() + (uint64_t)delayTicks, (uint64_t)slackTicks);
+    wd_insert(&wd->node);
+    g_wd.armed++;
+    if (wd->node.expiry < g_wd.wakeTick)
+        pthread_cond_signal(&g_wd.cv);
+    pthread_mutex_unlock(&g_wd.mtx);
+    return 0;
+}
 
-    int tps = sysClkRateGet();
-    if (tps <= 0) tps = 60;
-    unsigned long long ms = ((unsigned long long)delayTicks * 1000ULL) / (unsigned long long)tps;
+int wdStartPeriodic(WDOG_ID id, int periodTicks, WDOG_HANDLER func, uintptr_t arg) {
+    if (!id || !func || periodTicks <= 0) return -1;
+    WdControl* wd = (WdControl*)id;
 
-    pthread_mutex_lock(&wd->mtx);
+    pthread_mutex_lock(&g_wd.mtx);
+    wd_unlink(wd);
     wd->handler = func;
     wd->arg = arg;
-    wd->canceled = 0;
-    wd->active = 1;
-    wd->generation++;
-
-    // set absolute deadline
-    clock_gettime(CLOCK_MONOTONIC, &wd->deadline);
-    add_ms_to_timespec(&wd->deadline, ms);
-
-    unsigned long long myGen = wd->generation;
-    pthread_mutex_unlock(&wd->mtx);
-
-    // launch worker
-    pthread_attr_t attr;
-    pthread_attr_init(&attr);
-    // joinable by default
-    int rc = pthread_create(&wd->thread, &attr, wd_worker, wd);
-    pthread_attr_destroy(&attr);
-    if (rc != 0) {
-        // rollback state
-        pthread_mutex_lock(&wd->mtx);
-        wd->active = 0;
-        wd->canceled = 1;
-        wd->generation = myGen; // already incremented; leave it
-        pthread_mutex_unlock(&wd->mtx);
-        return -1;
-    }
-    wd->threadRunning = 1;
+    wd->period = (uint64_t)periodTicks;
+    wd->overruns = 0;
+    wd->node.expiry = wd_clock_locked() + wd->period;
+    wd_insert(&wd->node);
+    g_wd.armed++;
+    if (wd->node.expiry < g_wd.wakeTick)
+        pthread_cond_signal(&g_wd.cv);
+    pthread_mutex_unlock(&g_wd.mtx);
+    return 0;
+}
+
+int wdOverrunGet(WDOG_ID id, uint64_t* pOverruns) {
+    if (!id || !pOverruns) return -1;
+    WdControl* wd = (WdControl*)id;
+    pthread_mutex_lock(&g_wd.mtx);
+    *pOverruns = wd->overruns;
+    pthread_mutex_unlock(&g_wd.mtx);
+    return 0;
+}
+
+int wdOptionsSet(WDOG_ID id, int options) {
+    if (!id || (options & ~WD_OPT_INLINE)) return -1;
+    WdControl* wd = (WdControl*)id;
+    pthread_mutex_lock(&g_wd.mtx);
+    wd->options = options;
+    pthread_mutex_unlock(&g_wd.mtx);
+    return 0;
+}
+
+int wdPoolConfig(int nWorkers, int fifoPriority) {
+    if (nWorkers < 0 || nWorkers > WD_POOL_MAX ||
+        fifoPriority < 0 || fifoPriority > sched_get_priority_max(SCHED_FIFO)) return -1;
+    pthread_once(&g_wdOnce, wd_init);
+    if (!g_wdReady) return -1;
+    pthread_mutex_lock(&g_wdPoolLock);
+    int rc = wd_pool_resize(nWorkers, fifoPriority);
+    pthread_mutex_unlock(&g_wdPoolLock);
+    return rc;
+}
+
+int wdHandlerStatsGet(WDOG_ID id, WD_HANDLER_STATS* pStats) {
+    if (!id || !pStats) return -1;
+    WdControl* wd = (WdControl*)id;
+    pthread_mutex_lock(&g_wd.mtx);
+    pStats->runs = wd->stats.runs;
+    pStats->totalNs = wd->stats.totalNs;
+    pStats->maxNs = wd->stats.maxNs;
+    pthread_mutex_unlock(&g_wd.mtx);
+    wd_hist_read(&pStats->latency, &wd->stats.latency);
+    wd_hist_read(&pStats->runTime, &wd->stats.runTime);
+    return 0;
+}
+
+int wdStatsGet(WD_STATS* pStats) {
+    if (!pStats) return -1;
+    pthread_once(&g_wdOnce, wd_init);
+    pthread_mutex_lock(&g_wd.mtx);
+    pStats->wakeups = g_wd.wakeups;
+    pStats->expirations = g_wd.expirations;
+    pStats->elapsedNs = wd_mono_ns() - g_wd.startNs;
+    pStats->ticks = wd_clock_locked() - g_wd.startTick + 1;
+    pStats->maxPerTick = g_wd.maxPerTick;
+    pStats->armed = g_wd.armed;
+    pthread_mutex_unlock(&g_wd.mtx);
+    wd_hist_read(&pStats->latency, &g_wd.latency);
+    wd_hist_read(&pStats->runTime, &g_wd.runTime);
+    return 0;
+}
+
+/* Upper bound (us) of the bucket holding quantile @q */
+static uint64_t wd_hist_quantile_us(const WD_HIST* h, uint64_t total, double q) {
+    uint64_t target = (uint64_t)(q * (double)total), seen = 0;
+    for (int i = 0; i < WD_HIST_BUCKETS; i++) {
+        seen += h->count[i];
+        if (seen > target) return 1ULL << i;
+    }
+    return 1ULL << (WD_HIST_BUCKETS - 1);
+}
+
+static void wd_hist_show(const char* name, const WD_HIST* h) {
+    uint64_t total = 0;
+    for (int i = 0; i < WD_HIST_BUCKETS; i++) total += h->count[i];
+    printf("  %-8s samples %llu", name, (unsigned long long)total);
+    if (total == 0) {
+        printf("\n");
+        return;
+    }
+    printf("  p50 <%llu us  p99 <%llu us  max %.1f us\n",
+           (unsigned long long)wd_hist_quantile_us(h, total, 0.50),
+           (unsigned long long)wd_hist_quantile_us(h, total, 0.99),
+           (double)h->maxNs / 1000.0);
+    for (int i = 0; i < WD_HIST_BUCKETS; i++) {
+        if (h->count[i] == 0) continue;
+        if (i == 0) printf("    %10s < %-8d %llu\n", "", 1, (unsigned long long)h->count[i]);
+        else printf("    %10llu - %-8llu %llu\n", 1ULL << (i - 1), 1ULL << i, (unsigned long long)h->count[i]);
+    }
+}
+
+void wdShow(WDOG_ID id) {
+    if (!id) {
+        WD_STATS st;
+        if (wdStatsGet(&st) != 0) return;
+        double secs = (double)st.elapsedNs / 1e9;
+        printf("timer service: armed %llu  wakeups %llu (%.1f/s)  ticks %llu\n",
+               (unsigned long long)st.armed, (unsigned long long)st.wakeups,
+               secs > 0 ? (double)st.wakeups / secs : 0.0, (unsigned long long)st.ticks);
+        printf("  expirations %llu  per tick avg %.3f max %llu\n",
+               (unsigned long long)st.expirations,
+               st.ticks ? (double)st.expirations / (double)st.ticks : 0.0,
+               (unsigned long long)st.maxPerTick);
+        wd_hist_show("latency", &st.latency);
+        wd_hist_show("run", &st.runTime);
+        return;
+    }
+
+    WdControl* wd = (WdControl*)id;
+    WD_HANDLER_STATS hs;
+    pthread_mutex_lock(&g_wd.mtx);
+    int armed = wd->node.level != WD_SLOT_NONE;
+    uint64_t now = wd_clock_locked();
+    uint64_t left = armed && wd->node.expiry > now ? wd->node.expiry - now : 0;
+    uint64_t period = wd->period, overruns = wd->overruns;
+    int queued = wd->queuedRun, inFlight = wd->inFlight;
+    pthread_mutex_unlock(&g_wd.mtx);
+    wdHandlerStatsGet(id, &hs);
+
+    printf("watchdog %p: %s", id, armed ? "armed" : "idle");
+    if (armed) printf(", expires in %llu ticks", (unsigned long long)left);
+    if (period) printf(", period %llu, overruns %llu", (unsigned long long)period, (unsigned long long)overruns);
+    if (queued) printf(", queued");
+    if (inFlight) printf(", running");
+    printf("\n  runs %llu  avg %.1f us  max %.1f us\n", (unsigned long long)hs.runs,
+           hs.runs ? (double)hs.totalNs / (double)hs.runs / 1000.0 : 0.0, (double)hs.maxNs / 1000.0);
+    wd_hist_show("latency", &hs.latency);
+    wd_hist_show("run", &hs.runTime);
+}
+
+void wdPoolShow(void) {
+    pthread_once(&g_wdOnce, wd_init);
+    pthread_mutex_lock(&g_wd.mtx);
+    printf("workers %d  priority %d  queued %lu  armed %lu\n",
+           g_wd.nWorkers, g_wd.poolPriority, g_wd.queued, g_wd.armed);
+    printf("%-18s %-18s %10s %10s %10s %10s\n", "WDOG_ID", "handler", "runs", "avg(us)", "max(us)", "overruns");
+    for (WdLink* l = g_wd.all.next; l != &g_wd.all; l = l->next) {
+        WdControl* wd = WD_FROM_ALL(l);
+        if (wd->stats.runs == 0) continue;
+        printf("%-18p %-18p %10llu %10.1f %10.1f %10llu%s\n", (void*)wd, (void*)wd->handler,
+               (unsigned long long)wd->stats.runs,
+               (double)wd->stats.totalNs / (double)wd->stats.runs / 1000.0,
+               (double)wd->stats.maxNs / 1000.0,
+               (unsigned long long)wd->overruns,
+               (wd->options & WD_OPT_INLINE) ? "  inline" : "");
+    }
+    pthread_mutex_unlock(&g_wd.mtx);
+}
+
+WD_ARRAY_ID wdArrayCreate(int n, WD_ARRAY_HANDLER func, uintptr_t arg) {
+    if (n <= 0 || !func) return NULL;
+    pthread_once(&g_wdOnce, wd_init);
+    if (!g_wdReady) return NULL;
+    WdArray* arr = (WdArray*)calloc(1, sizeof(WdArray) + (size_t)(n - 1) * sizeof(WdArrayEntry));
+    if (!arr) return NULL;
+    arr->handler = func;
+    arr->arg = arg;
+    arr->n = n;
+    for (int i = 0; i < n; i++) {
+        link_init(&arr->entry[i].node.link);
+        arr->entry[i].node.level = WD_SLOT_NONE;
+        arr->entry[i].node.index = i;
+    }
+    return arr;
+}
+
+int wdArrayDelete(WD_ARRAY_ID id) {
+    if (!id) return -1;
+    WdArray* arr = (WdArray*)id;
+    pthread_mutex_lock(&g_wd.mtx);
+    for (int i = 0; i < arr->n; i++) {
+        __atomic_store_n(&arr->entry[i].deadline, 0, __ATOMIC_RELAXED);
+        wd_node_unlink(&arr->entry[i].node);
+    }
+    if (t_wdArrayCurrent == arr) {
+        arr->deleted = 1;
+        pthread_mutex_unlock(&g_wd.mtx);
+        return 0;
+    }
+    while (arr->inFlight > 0)
+        pthread_cond_wait(&g_wd.done, &g_wd.mtx);
+    free(arr);
+    pthread_mutex_unlock(&g_wd.mtx);
+    return 0;
+}
+
+int wdArrayStart(WD_ARRAY_ID id, int index, int delayTicks) {
+    WdArray* arr = (WdArray*)id;
+    if (!arr || index < 0 || index >= arr->n || delayTicks < 0) return -1;
+    WdArrayEntry* e = &arr->entry[index];
+
+    pthread_mutex_lock(&g_wd.mtx);
+    wd_node_unlink(&e->node);
+    e->node.expiry = wd_clock_locked() + (uint64_t)delayTicks;
+    __atomic_store_n(&e->deadline, e->node.expiry, __ATOMIC_RELEASE);
+    wd_insert(&e->node);
+    g_wd.armed++;
+    if (e->node.expiry < g_wd.wakeTick)
+        pthread_cond_signal(&g_wd.cv);
+    pthread_mutex_unlock(&g_wd.mtx);
+    return 0;
+}
+
+int wdArrayKick(WD_ARRAY_ID id, int index, int delayTicks) {
+    WdArray* arr = (WdArray*)id;
+    if (!arr || index < 0 || index >= arr->n || delayTicks < 0) return -1;
+    WdArrayEntry* e = &arr->entry[index];
+
+    // only moving an armed deadline later is lock-free: the wheel slot
+    // is never later than the deadline, so the entry is re-checked in time
+    uint64_t old = __atomic_load_n(&e->deadline, __ATOMIC_RELAXED);
+    if (old != 0) {
+        uint64_t d = wd_clock_peek() + (uint64_t)delayTicks;
+        while (old != 0 && d >= old) {
+            if (__atomic_compare_exchange_n(&e->deadline, &old, d, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+                return 0;
+        }
+    }
+    return wdArrayStart(id, index, delayTicks);
+}
+
+int wdArrayCancel(WD_ARRAY_ID id, int index) {
+    WdArray* arr = (WdArray*)id;
+    if (!arr || index < 0 || index >= arr->n) return -1;
+    WdArrayEntry* e = &arr->entry[index];
+    pthread_mutex_lock(&g_wd.mtx);
+    __atomic_store_n(&e->deadline, 0, __ATOMIC_RELAXED);
+    wd_node_unlink(&e->node);
+    pthread_mutex_unlock(&g_wd.mtx);
     return 0;
 }
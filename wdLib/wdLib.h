@@ -13,14 +13,84 @@ extern "C" {
 
 typedef void* WDOG_ID;
 typedef void (*WDOG_HANDLER)(uintptr_t arg);
+typedef void* WD_ARRAY_ID;
+typedef void (*WD_ARRAY_HANDLER)(WD_ARRAY_ID, int index, uintptr_t arg);
+
+/* wdOptionsSet options */
+#define WD_OPT_INLINE 0x1   /* run the handler on the timer-service thread, not the pool */
+
+/* Log2 histogram: bucket 0 counts values below 1 us, bucket i (i > 0)
+   values in [2^(i-1), 2^i) us; the last bucket also takes everything above */
+#define WD_HIST_BUCKETS 24
+typedef struct {
+    uint64_t count[WD_HIST_BUCKETS];
+    uint64_t maxNs;
+} WD_HIST;
+
+/* Handler run-time accounting */
+typedef struct {
+    uint64_t runs;      /* completed handler calls */
+    uint64_t totalNs;   /* accumulated handler run time (ns) */
+    uint64_t maxNs;     /* longest single run (ns) */
+    WD_HIST  latency;   /* scheduled deadline to handler start */
+    WD_HIST  runTime;   /* handler run time */
+} WD_HANDLER_STATS;
+
+/* Timer-service statistics (wdStatsGet); wakeups / elapsedNs is the wakeup rate */
+typedef struct {
+    uint64_t wakeups;       /* times the service thread woke to process the wheel */
+    uint64_t expirations;   /* watchdogs and array entries that fired */
+    uint64_t elapsedNs;     /* time since the service thread started */
+    uint64_t ticks;         /* wheel ticks since the service thread started */
+    uint64_t maxPerTick;    /* most expirations in a single tick */
+    uint64_t armed;         /* timers armed now, array entries included */
+    WD_HIST  latency;       /* all handlers: scheduled deadline to start */
+    WD_HIST  runTime;       /* all handlers: run time */
+} WD_STATS;
 
 /* Create / delete */
 WDOG_ID wdCreate(void);
 int     wdDelete(WDOG_ID);
-/* Start the watchdog: after delay ticks, call func(arg) on internal thread. */
+/* Start the watchdog: after delay ticks, call func(arg) on a handler pool thread. */
 int     wdStart(WDOG_ID, int delayTicks, WDOG_HANDLER func, uintptr_t arg);
+/* Start the watchdog with slack: it fires between delayTicks and
+   delayTicks + slackTicks from now, at a tick chosen so that watchdogs with
+   overlapping windows expire together and cost one wakeup. */
+int     wdStartSlack(WDOG_ID, int delayTicks, int slackTicks, WDOG_HANDLER func, uintptr_t arg);
+/* Start a periodic watchdog: call func(arg) every periodTicks until cancelled.
+   Each deadline is the previous one plus the period, so there is no drift. */
+int     wdStartPeriodic(WDOG_ID, int periodTicks, WDOG_HANDLER func, uintptr_t arg);
 /* Cancel a running watchdog */
 int     wdCancel(WDOG_ID);
+/* Periods skipped since wdStartPeriodic because the handler was still running
+   (or the timer service fell behind) */
+int     wdOverrunGet(WDOG_ID, uint64_t* pOverruns);
+/* Set WD_OPT_* options; WD_OPT_INLINE suits handlers of a few microseconds */
+int     wdOptionsSet(WDOG_ID, int options);
+/* Resize the prestarted handler pool (default 1 worker; 0 runs every handler
+   inline) and set its SCHED_FIFO priority (0 = default policy). Must not be
+   called from a handler. Returns -1 if the priority could not be applied. */
+int     wdPoolConfig(int nWorkers, int fifoPriority);
+/* Run-time statistics of a watchdog's handler */
+int     wdHandlerStatsGet(WDOG_ID, WD_HANDLER_STATS* pStats);
+/* Timer-service load, wakeups and global latency / run-time histograms */
+int     wdStatsGet(WD_STATS* pStats);
+/* Print one watchdog's state and histograms, or with NULL the timer service's */
+void    wdShow(WDOG_ID);
+/* Print pool state and the handler statistics of every watchdog that fired */
+void    wdPoolShow(void);
+
+/* Watchdog arrays: n timers addressed by index, e.g. one per connection.
+   Each expiry calls func(array, index, arg) on the timer-service thread,
+   so handlers must be short. wdArrayDelete may be called from a handler. */
+WD_ARRAY_ID wdArrayCreate(int n, WD_ARRAY_HANDLER func, uintptr_t arg);
+int     wdArrayDelete(WD_ARRAY_ID);
+/* Arm (or re-arm) entry index to expire after delayTicks */
+int     wdArrayStart(WD_ARRAY_ID, int index, int delayTicks);
+/* Push an armed entry's expiry out to delayTicks from now. Lock-free when the
+   new expiry is not earlier than the current one; otherwise same as wdArrayStart. */
+int     wdArrayKick(WD_ARRAY_ID, int index, int delayTicks);
+int     wdArrayCancel(WD_ARRAY_ID, int index);
 
 #ifdef __cplusplus
 }
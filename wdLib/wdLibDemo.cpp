@@ -0,0 +1,214 @@
+/**
+ * @file wdLibDemo.cpp
+ * @brief Demo application for the watchdog library
+ * @details Checks the timer service: a delay long enough to be cascaded
+ * down the wheel, handlers that cancel, re-arm and delete watchdogs,
+ * periodic overruns on the handler pool and inline, watchdog array kicks,
+ * and the wakeups that wdStartSlack saves. Prints [ok] or [FAILED] per
+ * check and exits non-zero if any failed.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include "wdLib.h"
+#include "tickLib.h"
+
+#define SLACK_TIMERS 32
+
+static int g_failures = 0;
+static uint64_t g_t0;
+static uint64_t g_firedNs;
+static int g_runs;
+static WDOG_ID g_victim;
+static int g_victimRuns;
+static uint64_t g_entryNs[2];
+
+static uint64_t nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static double sinceStartMs(uint64_t ns) {
+    return (double)(ns - g_t0) / 1e6;
+}
+
+static int runs(void) {
+    return __atomic_load_n(&g_runs, __ATOMIC_RELAXED);
+}
+
+static void check(int ok, const char* what) {
+    printf("  [%s] %s\n", ok ? "ok" : "FAILED", what);
+    if (!ok) g_failures++;
+}
+
+/**
+ * @brief Records when it ran
+ */
+static void stamp(uintptr_t arg) {
+    (void)arg;
+    __atomic_store_n(&g_firedNs, nowNs(), __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Re-arms its own watchdog until it has run three times
+ */
+static void rearm(uintptr_t arg) {
+    if (__atomic_add_fetch(&g_runs, 1, __ATOMIC_RELAXED) < 3) wdStart((WDOG_ID)arg, 10, rearm, arg);
+}
+
+/**
+ * @brief Cancels its own periodic watchdog on the third run
+ */
+static void cancelSelf(uintptr_t arg) {
+    if (__atomic_add_fetch(&g_runs, 1, __ATOMIC_RELAXED) == 3) wdCancel((WDOG_ID)arg);
+}
+
+/**
+ * @brief Cancels another watchdog that is due later, then deletes its own
+ */
+static void cancelOtherDeleteSelf(uintptr_t arg) {
+    wdCancel(g_victim);
+    wdDelete((WDOG_ID)arg);
+    __atomic_add_fetch(&g_runs, 1, __ATOMIC_RELAXED);
+}
+
+static void victim(uintptr_t arg) {
+    (void)arg;
+    __atomic_add_fetch(&g_victimRuns, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Array handler: records when each entry expired
+ */
+static void entryExpired(WD_ARRAY_ID arr, int index, uintptr_t arg) {
+    (void)arr;
+    (void)arg;
+    __atomic_store_n(&g_entryNs[index], nowNs(), __ATOMIC_RELEASE);
+}
+
+static void noop(uintptr_t arg) {
+    (void)arg;
+}
+
+/**
+ * @brief Periodic handler that takes three times its 1-tick period
+ */
+static void slowTick(uintptr_t arg) {
+    (void)arg;
+    usleep(50 * 1000);
+}
+
+/**
+ * @brief Runs slowTick every tick for one second and reports the overruns
+ */
+static void overrunRun(int inlineRun) {
+    WDOG_ID wd = wdCreate();
+    if (inlineRun) wdOptionsSet(wd, WD_OPT_INLINE);
+    wdStartPeriodic(wd, 1, slowTick, 0);
+    sleep(1);
+    wdCancel(wd);
+
+    uint64_t overruns = 0;
+    WD_HANDLER_STATS hs;
+    wdOverrunGet(wd, &overruns);
+    wdHandlerStatsGet(wd, &hs);
+    printf("%s: %llu runs, %llu overruns, latest start %.1f ms after its deadline\n",
+           inlineRun ? "inline" : "pool", (unsigned long long)hs.runs,
+           (unsigned long long)overruns, (double)hs.latency.maxNs / 1e6);
+    check(hs.runs >= 10 && hs.runs <= 25, "about one run per 50 ms handler");
+    check(overruns >= (uint64_t)sysClkRateGet() / 2, "the periods the handler overran are counted");
+    check(hs.latency.maxNs < 100 * 1000000ULL, "runs do not fall further and further behind");
+    wdDelete(wd);
+}
+
+int main() {
+    printf("Watchdog Library Demo\n");
+    printf("=====================\n");
+
+    printf("\n--- Periodic overruns: 50 ms handler, 1-tick period at %d Hz ---\n", sysClkRateGet());
+    overrunRun(0);
+    overrunRun(1);
+
+    // everything below runs at 1000 ticks per second, so one tick is 1 ms
+    sysClkRateSet(1000);
+
+    printf("\n--- Long delay: 300 ticks, past the 256 one-tick slots ---\n");
+    WDOG_ID wd = wdCreate();
+    g_t0 = nowNs();
+    wdStart(wd, 300, stamp, 0);
+    usleep(400 * 1000);
+    uint64_t fired = __atomic_load_n(&g_firedNs, __ATOMIC_ACQUIRE);
+    printf("fired %.1f ms after wdStart\n", fired ? sinceStartMs(fired) : -1.0);
+    check(fired && sinceStartMs(fired) >= 299.0 && sinceStartMs(fired) < 350.0,
+          "cascaded watchdog fires on time");
+
+    printf("\n--- Handlers that re-arm, cancel and delete ---\n");
+    __atomic_store_n(&g_runs, 0, __ATOMIC_RELAXED);
+    wdStart(wd, 10, rearm, (uintptr_t)wd);
+    usleep(200 * 1000);
+    printf("re-arming handler ran %d times\n", runs());
+    check(runs() == 3, "a handler can re-arm its own watchdog");
+
+    __atomic_store_n(&g_runs, 0, __ATOMIC_RELAXED);
+    wdStartPeriodic(wd, 10, cancelSelf, (uintptr_t)wd);
+    usleep(200 * 1000);
+    printf("self-cancelling periodic handler ran %d times\n", runs());
+    check(runs() == 3, "a handler can cancel its own periodic watchdog");
+    wdDelete(wd);
+
+    __atomic_store_n(&g_runs, 0, __ATOMIC_RELAXED);
+    g_victim = wdCreate();
+    wd = wdCreate();
+    wdStart(g_victim, 50, victim, 0);
+    wdStart(wd, 10, cancelOtherDeleteSelf, (uintptr_t)wd);
+    usleep(200 * 1000);
+    printf("deleting handler ran %d times, the watchdog it cancelled %d times\n", runs(),
+           __atomic_load_n(&g_victimRuns, __ATOMIC_RELAXED));
+    check(runs() == 1 && __atomic_load_n(&g_victimRuns, __ATOMIC_RELAXED) == 0,
+          "a handler can cancel another watchdog and delete its own");
+    wdDelete(g_victim);
+
+    printf("\n--- Watchdog array: entry 0 kicked every 20 ms, entry 1 left alone ---\n");
+    WD_ARRAY_ID arr = wdArrayCreate(2, entryExpired, 0);
+    g_t0 = nowNs();
+    wdArrayStart(arr, 0, 50);
+    wdArrayStart(arr, 1, 50);
+    for (int i = 0; i < 10; i++) {
+        usleep(20 * 1000);
+        wdArrayKick(arr, 0, 50);
+    }
+    uint64_t lastKick = nowNs();
+    usleep(150 * 1000);
+    uint64_t e0 = __atomic_load_n(&g_entryNs[0], __ATOMIC_ACQUIRE);
+    uint64_t e1 = __atomic_load_n(&g_entryNs[1], __ATOMIC_ACQUIRE);
+    printf("entry 1 expired at %.1f ms, entry 0 at %.1f ms (last kick at %.1f ms)\n",
+           e1 ? sinceStartMs(e1) : -1.0, e0 ? sinceStartMs(e0) : -1.0, sinceStartMs(lastKick));
+    check(e1 && sinceStartMs(e1) >= 49.0 && sinceStartMs(e1) < 100.0, "an unkicked entry expires on time");
+    check(e0 && e0 >= lastKick + 49 * 1000000ULL, "kicks postpone an entry until 50 ms after the last one");
+    wdArrayDelete(arr);
+
+    printf("\n--- wdStartSlack: %d watchdogs 3 ticks apart ---\n", SLACK_TIMERS);
+    WDOG_ID many[SLACK_TIMERS];
+    for (int i = 0; i < SLACK_TIMERS; i++) many[i] = wdCreate();
+    uint64_t wakeups[2];
+    for (int slack = 0; slack < 2; slack++) {
+        WD_STATS before, after;
+        wdStatsGet(&before);
+        for (int i = 0; i < SLACK_TIMERS; i++) {
+            if (slack) wdStartSlack(many[i], 20 + 3 * i, 100, noop, 0);
+            else wdStart(many[i], 20 + 3 * i, noop, 0);
+        }
+        usleep(300 * 1000);
+        wdStatsGet(&after);
+        wakeups[slack] = after.wakeups - before.wakeups;
+        printf("%s: %llu service-thread wakeups\n", slack ? "with 100 ticks of slack" : "exact deadlines",
+               (unsigned long long)wakeups[slack]);
+    }
+    check(wakeups[1] * 4 <= wakeups[0], "slack lets the watchdogs share wakeups");
+    for (int i = 0; i < SLACK_TIMERS; i++) wdDelete(many[i]);
+
+    printf("\n%s\n", g_failures ? "Demo FAILED" : "Demo completed");
+    return g_failures ? 1 : 0;
+}